@@ -0,0 +1,79 @@
+// [RU] === ansi.h — ANSI-кодировщик кадра: только изменившиеся ячейки, слитые перемещения курсора и смены цвета ===
+// [EN] === ansi.h — ANSI frame encoder: changed cells only, coalesced cursor moves and color changes ===
+#pragma once
+#include "render.h"                            // [RU] Frame, Cell, биты ATTR_*
+                                               // [EN] Frame, Cell, ATTR_* bits
+#include <string>
+#include <vector>
+
+// [RU] --- Цвет WinAPI-атрибута → код SGR: ANSI нумерует R=1,G=2,B=4, WinAPI — B=1,G=2,R=4 ---
+// [EN] --- WinAPI attribute color → SGR code: ANSI numbers R=1,G=2,B=4, WinAPI — B=1,G=2,R=4 ---
+static inline int sgrForAttr(uint16_t attr){
+    int idx=((attr&ATTR_RED)?1:0)|((attr&ATTR_GREEN)?2:0)|((attr&ATTR_BLUE)?4:0);
+    return ((attr&ATTR_BRIGHT)?90:30)+idx;     // [RU] 90–97 — яркие цвета переднего плана
+                                               // [EN] 90–97 — bright foreground colors
+}
+static inline void appendInt(std::string&out,int v){ // [RU] Без snprintf и без аллокаций
+                                                     // [EN] No snprintf and no allocations
+    char tmp[12]; int n=0; do{ tmp[n++]=(char)('0'+v%10); v/=10; }while(v>0);
+    while(n) out+=tmp[--n];
+}
+
+// [RU] --- Дельта-кодировщик: помнит, что уже на экране, и шлёт только разницу ---
+// [EN] --- Delta encoder: remembers what is already on screen and sends only the difference ---
+struct AnsiEncoder{
+    int W=0,H=0;                               // [RU] Размер кадра на экране
+                                               // [EN] Size of the on-screen frame
+    std::vector<Cell> prev;                    // [RU] Копия того, что сейчас показывает терминал
+                                               // [EN] Copy of what the terminal currently shows
+    bool valid=false;                          // [RU] false → следующий кадр рисуется целиком
+                                               // [EN] false → the next frame is drawn in full
+    int sgr=-1;                                // [RU] Текущий SGR терминала (-1 — неизвестен)
+                                               // [EN] Terminal's current SGR (-1 — unknown)
+    uint64_t frames=0, bytes=0;                // [RU] Статистика для bytes/frame
+                                               // [EN] Statistics for bytes/frame
+
+    void invalidate(){ valid=false; }          // [RU] Ресайз или чужой вывод — экран больше не совпадает с prev
+                                               // [EN] Resize or foreign output — the screen no longer matches prev
+    static bool same(const Cell&a,const Cell&b){ return a.ch==b.ch && (a.ch==' '||a.attr==b.attr); } // [RU] Цвет пробела не виден
+                                                                                                       // [EN] A space's color is invisible
+
+    void encode(const Frame&fr,std::string&out){ // [RU] Дописывает байты кадра в out
+                                                 // [EN] Appends the frame's bytes to out
+        const size_t start=out.size();
+        if(!valid||fr.W!=W||fr.H!=H){          // [RU] Полная перерисовка: сброс цвета, очистка экрана
+                                               // [EN] Full redraw: reset color, clear screen
+            W=fr.W; H=fr.H; prev.assign((size_t)W*(size_t)H,Cell{' ',0}); valid=true;
+            out+="\x1b[0m\x1b[2J"; sgr=0;      // [RU] После 2J экран — пробелы, prev это уже отражает
+                                               // [EN] After 2J the screen is spaces, which prev already reflects
+        }
+        int cx=-1, cy=-1;                      // [RU] Где курсор (-1 — неизвестно)
+                                               // [EN] Where the cursor is (-1 — unknown)
+        for(int y=0;y<H;++y){
+            const size_t base=(size_t)y*(size_t)W; Cell*old=&prev[base];
+            for(int x=0;x<W;++x){
+                const Cell cur=fr.at(base+(size_t)x);
+                if(same(cur,old[x])) continue;
+                if(cy!=y||cx!=x){              // [RU] Курсор не там — выбираем самый дешёвый способ дойти
+                                               // [EN] Cursor is elsewhere — pick the cheapest way to get there
+                    int gap=x-cx; bool reuse=cy==y&&gap>0&&gap<=3;
+                    for(int k=cx;reuse&&k<x;++k){ const Cell c=fr.at(base+(size_t)k); reuse=c.ch==' '||sgrForAttr(c.attr)==sgr; }
+                    if(reuse){ for(int k=cx;k<x;++k){ old[k]=fr.at(base+(size_t)k); out+=old[k].ch; } } // [RU] Перепечатать ≤3 ячеек дешевле ESC[nC
+                                                                                                        // [EN] Reprinting ≤3 cells beats ESC[nC
+                    else if(cy==y&&gap>0){ out+="\x1b["; appendInt(out,gap); out+='C'; } // [RU] Вправо по строке
+                                                                                          // [EN] Forward along the row
+                    else { out+="\x1b["; appendInt(out,y+1); out+=';'; appendInt(out,x+1); out+='H'; } // [RU] Абсолютная позиция
+                                                                                                        // [EN] Absolute position
+                }
+                if(cur.ch!=' '){ int want=sgrForAttr(cur.attr); // [RU] Цвет меняем только для видимых символов
+                                                                // [EN] Color is changed only for visible glyphs
+                    if(want!=sgr){ out+="\x1b["; appendInt(out,want); out+='m'; sgr=want; } }
+                out+=cur.ch; old[x]=cur;
+                cx = x+1<W ? x+1 : -1; cy = x+1<W ? y : -1; // [RU] В последней колонке курсор «висит» — позиция неоднозначна
+                                                            // [EN] At the last column the cursor "hangs" — the position is ambiguous
+            }
+        }
+        bytes+=out.size()-start; ++frames;
+    }
+    double bytesPerFrame()const{ return frames ? (double)bytes/(double)frames : 0.0; }
+};
@@ -0,0 +1,45 @@
+// [RU] === arena.h — линейная арена под память кадра: один выровненный блок, выдача сдвигом указателя ===
+// [EN] === arena.h — linear arena for frame memory: one aligned block, bump-pointer allocation ===
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <new>                                 // [RU] operator new с выравниванием
+                                               // [EN] Aligned operator new
+#include <utility>                             // [RU] std::swap
+                                               // [EN] std::swap
+
+// [RU] Блок растёт только когда запрос не влезает в ёмкость — ресайз окна назад/вперёд и обычные кадры
+// [RU] идут без обращений к куче. Рост сбрасывает арену: выданные раньше указатели становятся недействительны.
+// [EN] The block grows only when a request does not fit its capacity — resizing the window back and forth
+// [EN] and ordinary frames never touch the heap. Growth resets the arena: earlier pointers become invalid.
+struct Arena{
+    static constexpr size_t ALIGN=64;          // [RU] Строка кеша — ячейки не делят строку с чужими данными
+                                               // [EN] A cache line — cells never share a line with foreign data
+    char*base=nullptr; size_t cap=0, used=0;
+    uint64_t grows=0;                          // [RU] Сколько раз шли в кучу — для статистики
+                                               // [EN] How many times the heap was hit — for statistics
+
+    Arena(){}
+    Arena(const Arena&)=delete; Arena&operator=(const Arena&)=delete;
+    ~Arena(){ release(); }
+
+    void swap(Arena&o){ std::swap(base,o.base); std::swap(cap,o.cap); std::swap(used,o.used); std::swap(grows,o.grows); }
+    void reset(){ used=0; }                    // [RU] Всё выданное — снова свободно, память остаётся
+                                               // [EN] Everything handed out is free again, the memory stays
+    void reserve(size_t bytes){                // [RU] Гарантирует ёмкость; при росте — запас 1.5×, чтобы тянуть окно без аллокаций на каждый шаг
+                                               // [EN] Ensures capacity; on growth keeps 1.5× headroom so dragging a window does not allocate every step
+        if(bytes<=cap) return;
+        size_t want=cap+cap/2; if(want<bytes) want=bytes;
+        want=(want+ALIGN-1)&~(ALIGN-1);
+        release();
+        base=(char*)::operator new(want,std::align_val_t(ALIGN)); cap=want; ++grows;
+    }
+    template<class T> T*alloc(size_t n){       // [RU] Выровненный кусок; при нехватке — рост (с потерей прежнего содержимого)
+                                               // [EN] An aligned chunk; when short — growth (losing the previous contents)
+        size_t off=(used+ALIGN-1)&~(ALIGN-1), bytes=n*sizeof(T);
+        if(off+bytes>cap){ reserve(off+bytes); off=0; }
+        used=off+bytes; return (T*)(base+off);
+    }
+private:
+    void release(){ if(base) ::operator delete(base,std::align_val_t(ALIGN)); base=nullptr; cap=0; used=0; }
+};
@@ -0,0 +1,532 @@
+// [RU] === bench.cpp — воспроизводимый бенчмарк пропускной способности кадров (headless) ===
+// [EN] === bench.cpp — reproducible frame-throughput benchmark (headless) ===
+#include "pipeline.h"                          // [RU] Ядро рендера без <windows.h>
+                                               // [EN] Renderer core without <windows.h>
+#include "ansi.h"                              // [RU] Дельта-кодировщик — меряем байты/кадр
+                                               // [EN] Delta encoder — measures bytes/frame
+#include "record.h"                            // [RU] Цена --record и проверка воспроизведения
+                                               // [EN] Cost of --record and replay verification
+#include <chrono>                              // [RU] Замеры времени кадра
+                                               // [EN] Frame timing
+#include <cstdio>                              // [RU] Табличный вывод
+                                               // [EN] Tabular output
+#include <cstdlib>                             // [RU] atoi/atof/strtoull
+                                               // [EN] atoi/atof/strtoull
+#include <cstring>                             // [RU] Разбор аргументов
+                                               // [EN] Argument parsing
+#include <thread>                              // [RU] hardware_concurrency
+                                               // [EN] hardware_concurrency
+#include <filesystem>                          // [RU] Временные файлы синтетического меша
+                                               // [EN] Temporary files for the synthetic mesh
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <atomic>                              // [RU] Счётчик аллокаций из всех потоков
+                                               // [EN] Allocation counter across all threads
+#include <new>
+
+// [RU] --- Счётчик обращений к куче: подменённый operator new — доказательство, что цикл кадра память не выделяет ---
+// [EN] --- Heap allocation counter: a replaced operator new — proof that the frame loop allocates nothing ---
+// [RU] Заменён весь набор: обычные, массивы, sized, aligned и nothrow — любой new парен своему delete. Пара
+// [RU] countedAlloc/countedFree не встраивается: иначе GCC видит free() против operator new и шумит -Wmismatched-new-delete.
+// [EN] The whole set is replaced: plain, array, sized, aligned and nothrow — every new pairs with its delete. The
+// [EN] countedAlloc/countedFree pair is not inlined: otherwise GCC sees free() against operator new and warns -Wmismatched-new-delete.
+#if defined(__GNUC__)||defined(__clang__)
+#define BENCH_NOINLINE __attribute__((noinline))
+#elif defined(_MSC_VER)
+#define BENCH_NOINLINE __declspec(noinline)
+#else
+#define BENCH_NOINLINE
+#endif
+static std::atomic<uint64_t> heapAllocs{0};
+BENCH_NOINLINE static void* countedAlloc(std::size_t n,std::size_t align){
+    heapAllocs.fetch_add(1,std::memory_order_relaxed);
+    if(!n) n=1;
+#ifdef _WIN32
+    void*p = align ? _aligned_malloc(n,align) : std::malloc(n);
+#else
+    void*p = align ? std::aligned_alloc(align,(n+align-1)/align*align) : std::malloc(n);
+#endif
+    if(!p) throw std::bad_alloc();
+    return p;
+}
+BENCH_NOINLINE static void countedFree(void*p,bool aligned){
+#ifdef _WIN32
+    if(aligned){ _aligned_free(p); return; }
+#else
+    (void)aligned;
+#endif
+    std::free(p);
+}
+void* operator new(std::size_t n){ return countedAlloc(n,0); }
+void* operator new[](std::size_t n){ return countedAlloc(n,0); }
+void* operator new(std::size_t n,std::align_val_t a){ return countedAlloc(n,(std::size_t)a); }
+void* operator new[](std::size_t n,std::align_val_t a){ return countedAlloc(n,(std::size_t)a); }
+void* operator new(std::size_t n,const std::nothrow_t&) noexcept { try{ return countedAlloc(n,0); }catch(...){ return nullptr; } }
+void* operator new[](std::size_t n,const std::nothrow_t&) noexcept { try{ return countedAlloc(n,0); }catch(...){ return nullptr; } }
+void* operator new(std::size_t n,std::align_val_t a,const std::nothrow_t&) noexcept { try{ return countedAlloc(n,(std::size_t)a); }catch(...){ return nullptr; } }
+void* operator new[](std::size_t n,std::align_val_t a,const std::nothrow_t&) noexcept { try{ return countedAlloc(n,(std::size_t)a); }catch(...){ return nullptr; } }
+void operator delete(void*p) noexcept { countedFree(p,false); }
+void operator delete[](void*p) noexcept { countedFree(p,false); }
+void operator delete(void*p,std::size_t) noexcept { countedFree(p,false); }
+void operator delete[](void*p,std::size_t) noexcept { countedFree(p,false); }
+void operator delete(void*p,std::align_val_t) noexcept { countedFree(p,true); }
+void operator delete[](void*p,std::align_val_t) noexcept { countedFree(p,true); }
+void operator delete(void*p,std::size_t,std::align_val_t) noexcept { countedFree(p,true); }
+void operator delete[](void*p,std::size_t,std::align_val_t) noexcept { countedFree(p,true); }
+void operator delete(void*p,const std::nothrow_t&) noexcept { countedFree(p,false); }
+void operator delete[](void*p,const std::nothrow_t&) noexcept { countedFree(p,false); }
+void operator delete(void*p,std::align_val_t,const std::nothrow_t&) noexcept { countedFree(p,true); }
+void operator delete[](void*p,std::align_val_t,const std::nothrow_t&) noexcept { countedFree(p,true); }
+
+// [RU] --- Эталонные контрольные суммы: фиксированная последовательность углов, шаг по умолчанию ---
+// [EN] --- Golden checksums: fixed angle sequence, default step ---
+struct Golden{ RasterMode mode; int W,H,frames; uint64_t sum; };
+static const Golden goldens[]={
+    {RasterMode::Sampler,   80, 25,240,0x05c3a0a0c4090513ull},
+    {RasterMode::Sampler,  120, 40,240,0x7613328268073d1aull},
+    {RasterMode::Sampler,  200, 60,240,0x216f033d5c3b0b11ull},
+    {RasterMode::Sampler,  400,120,240,0x932972463c839ae2ull},
+    {RasterMode::Sampler, 1000,400,240,0x005eb13664341227ull},
+    {RasterMode::Scanline,  80, 25,240,0x3bfc8c282f4200adull},
+    {RasterMode::Scanline, 120, 40,240,0x34a5462f98f8bb99ull},
+    {RasterMode::Scanline, 200, 60,240,0x5e50ee2aac323963ull},
+    {RasterMode::Scanline, 400,120,240,0x05e83f65396940bcull},
+    {RasterMode::Scanline,1000,400,240,0x5e8dd4cbfc7e1368ull},
+    {RasterMode::Batch,     80, 25,240,0x05c3a0a0c4090513ull},
+    {RasterMode::Batch,    120, 40,240,0xa05a5920ff619716ull},
+    {RasterMode::Batch,    200, 60,240,0xab7fc5e2cf9ed800ull},
+    {RasterMode::Batch,    400,120,240,0x68d1241c7352bfe9ull},
+    {RasterMode::Batch,   1000,400,240,0xa3e69020bcc13650ull},
+};
+
+// [RU] --- Куб больше расстояния до камеры: углы уходят за ближнюю плоскость, общие рёбра отсекаются с обеих граней ---
+// [EN] --- A cube larger than the camera distance: corners cross the near plane, shared edges are clipped from both faces ---
+struct NearGolden{ int W,H,frames; float scale; uint64_t sum; };
+static const NearGolden nearGoldens[]={
+    { 37, 91,240,2.2f,0xce36a9aaec0ec068ull},
+    { 37, 91,240,3.0f,0xe6a41088e68b1fb3ull},
+    {120, 40,240,2.2f,0x413c88d594ca9d8bull},
+    {120, 91,240,2.0f,0x41473f09a6e3d52full},   // [RU] Кадр 10: срез у ближней плоскости зависит от порядка концов ребра
+                                                // [EN] Frame 10: the near-plane cut depends on the edge's endpoint order
+};
+
+struct Res{ int W,H; };                        // [RU] Разрешение прогона в символах
+                                               // [EN] Run resolution in characters
+struct TraceRow{ RasterMode mode; int thr; Res r; uint64_t count[TC_COUNT]; }; // [RU] Счётчики прогона (сборка с -DCUBE_TRACE)
+                                                                               // [EN] A run's counters (build with -DCUBE_TRACE)
+
+static double percentile(std::vector<double> v,double p){ // [RU] Перцентиль по ближайшему рангу
+                                                          // [EN] Nearest-rank percentile
+    std::sort(v.begin(),v.end());
+    size_t k=(size_t)std::ceil(p*(double)v.size()); if(k>0) --k;
+    return v[std::min(k,v.size()-1)];
+}
+
+// [RU] --- Микробенчмарк ядра преобразования: ns/точку по ISA + побитная сверка со scalar ---
+// [EN] --- Transform kernel microbenchmark: ns/point per ISA + bit-exact check against scalar ---
+static int benchKernels(size_t n,int reps){
+    std::vector<float> x(n),y(n),z(n),invz(n),refInvz(n); std::vector<uint32_t> idx(n),refIdx(n);
+    uint32_t seed=12345;                       // [RU] Детерминированный LCG — без <random> и его различий
+                                               // [EN] Deterministic LCG — no <random> and its variations
+    auto rnd=[&]{ seed=seed*1664525u+1013904223u; return (float)(seed>>8)/(float)(1u<<24)*2.0f-1.0f; };
+    for(size_t i=0;i<n;++i){ x[i]=rnd(); y[i]=rnd(); z[i]=rnd(); }
+    Projector proj(Geom{1000,400,2.0f}); RenderParams rp;
+    const Xform t=makeXform(Pose::at(0.37f,1.0f),rp.cubeScale,rp.camZ); const ProjK k=makeProjK(proj,rp.nearZ);
+    transformScalar(x.data(),y.data(),z.data(),n,t,k,refIdx.data(),refInvz.data());
+    std::printf("\n%-8s %10s %10s %9s %s\n","kernel","points","ns/point","speedup","exact");
+    double scalarNs=0; int failures=0;
+    for(Isa isa:{Isa::Scalar,Isa::SSE2,Isa::AVX2}){
+        if(!isaSupported(isa)){ std::printf("%-8s %10s\n",isaName(isa),"n/a"); continue; }
+        BatchFn fn=batchKernel(isa);
+        auto t0=std::chrono::steady_clock::now();
+        for(int r=0;r<reps;++r) fn(x.data(),y.data(),z.data(),n,t,k,idx.data(),invz.data());
+        double nsPt=(double)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now()-t0).count()/((double)n*reps);
+        if(isa==Isa::Scalar) scalarNs=nsPt;
+        bool exact = idx==refIdx && std::memcmp(invz.data(),refInvz.data(),n*sizeof(float))==0;
+        if(!exact) ++failures;
+        std::printf("%-8s %10zu %10.3f %8.2fx %s\n",isaName(isa),n,nsPt,scalarNs/nsPt,exact?"ok":"MISMATCH");
+    }
+    return failures;
+}
+
+// [RU] --- Синтетический меш: «бугристая» сфера ~tris треугольников — невыпуклая, z-буфер работает по-настоящему ---
+// [EN] --- Synthetic mesh: a "bumpy" sphere of ~tris triangles — non-convex, so the z-buffer really works ---
+static Mesh bumpySphere(size_t tris){
+    const int S=std::max(3,(int)std::sqrt((double)tris/4.0)), L=2*S; // [RU] 2·L·(S-1) треугольников
+                                                                      // [EN] 2·L·(S-1) triangles
+    Mesh m; m.pos.reserve((size_t)L*(S-1)+2);
+    auto at=[&](float th,float ph){ float r=1.0f+0.15f*std::sin(6.0f*th)*std::cos(5.0f*ph);
+        return Vec3{r*std::sin(th)*std::cos(ph), r*std::cos(th), r*std::sin(th)*std::sin(ph)}; };
+    m.pos.push_back({0,1,0});                  // [RU] Северный полюс — индекс 0
+                                               // [EN] North pole — index 0
+    for(int i=1;i<S;++i) for(int j=0;j<L;++j) m.pos.push_back(at(3.14159265f*(float)i/(float)S,6.28318531f*(float)j/(float)L));
+    m.pos.push_back({0,-1,0});                 // [RU] Южный полюс — последний
+                                               // [EN] South pole — last
+    auto v=[&](int i,int j)->uint32_t{ return i==0 ? 0u : i==S ? (uint32_t)m.pos.size()-1 : (uint32_t)(1+(i-1)*L+(j%L)); };
+    for(int i=0;i<S;++i) for(int j=0;j<L;++j){ // [RU] Против часовой снаружи: (a,b,c) и (b,d,c)
+                                               // [EN] Counter-clockwise from outside: (a,b,c) and (b,d,c)
+        const uint32_t a=v(i,j),b=v(i,j+1),c=v(i+1,j),d=v(i+1,j+1);
+        if(i>0){ m.idx.push_back(a); m.idx.push_back(b); m.idx.push_back(c); }
+        if(i<S-1){ m.idx.push_back(b); m.idx.push_back(d); m.idx.push_back(c); }
+    }
+    m.finish();
+    return m;
+}
+static bool saveStl(const Mesh&m,const std::string&path){ // [RU] Бинарный STL одним fwrite
+                                                          // [EN] Binary STL in a single fwrite
+    std::vector<char> buf(84+m.tris()*50,0); const uint32_t n=(uint32_t)m.tris(); std::memcpy(&buf[80],&n,4);
+    for(size_t t=0;t<m.tris();++t){ char*p=&buf[84+t*50]; std::memcpy(p,&m.faceN[t],12);
+        for(int k=0;k<3;++k) std::memcpy(p+12+12*k,&m.pos[m.idx[t*3+k]],12); }
+    FILE*f=std::fopen(path.c_str(),"wb"); if(!f) return false;
+    bool ok=std::fwrite(buf.data(),1,buf.size(),f)==buf.size(); return std::fclose(f)==0&&ok;
+}
+static bool saveObj(const Mesh&m,const std::string&path){ // [RU] %.9g — float переживает текст без потерь
+                                                          // [EN] %.9g — a float survives the text round trip exactly
+    FILE*f=std::fopen(path.c_str(),"wb"); if(!f) return false;
+    std::fprintf(f,"# bumpy sphere, %zu triangles\n",m.tris());
+    for(const Vec3&p:m.pos) std::fprintf(f,"v %.9g %.9g %.9g\n",p.x,p.y,p.z);
+    for(size_t t=0;t<m.tris();++t) std::fprintf(f,"f %u %u %u\n",m.idx[t*3]+1,m.idx[t*3+1]+1,m.idx[t*3+2]+1);
+    return std::fclose(f)==0;
+}
+
+// [RU] --- Сэмплер: исходный цикл renderCube против ядер на таблицах; кадры обязаны совпасть побитно ---
+// [EN] --- Sampler: the original renderCube loop against the table-driven kernels; frames must match bit for bit ---
+// [RU] Второй шаг (не по умолчанию) идёт через кешированную ось, а не через таблицу компиляции.
+// [EN] The second (non-default) step goes through the cached axis rather than the compile-time table.
+static int benchSampler(const std::vector<Res>&res,int frames,RenderParams rp,float aspect){
+    std::printf("\n%-9s %-10s %7s %11s %11s %13s %11s %8s  %s\n","sampler","res","step","generic us","table us","generic ns/pt","table ns/pt","speedup","match");
+    int failures=0; TableSampler ts;
+    std::vector<float> steps={rp.step}; if(rp.step!=0.02f) steps.push_back(0.02f);
+    for(float step:steps) for(const Res&r:res){
+        rp.step=step;
+        Projector proj(Geom{r.W,r.H,aspect}); Frame frame; frame.resize(r.W,r.H);
+        double ns[2]={0,0}; uint64_t sum[2]={0,0}, pts=0;
+        for(int pass=0;pass<2;++pass){         // [RU] 0 — renderCube, 1 — TableSampler; одни и те же позы
+                                               // [EN] 0 — renderCube, 1 — TableSampler; the very same poses
+            uint64_t h=1469598103934665603ull; const uint64_t s0=ts.samples;
+            for(int i=0;i<frames;++i){
+                const Pose ps=Pose::at((float)i/60.0f,1.0f);
+                auto f0=std::chrono::steady_clock::now();
+                if(pass) ts.render(frame,proj,rp,ps); else renderCube(frame,proj,rp,ps);
+                ns[pass]+=(double)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now()-f0).count();
+                h=frameChecksum(frame,h);
+            }
+            sum[pass]=h; if(pass) pts=ts.samples-s0;
+        }
+        const bool ok=sum[0]==sum[1]; if(!ok) ++failures;
+        char rs[32]; std::snprintf(rs,sizeof rs,"%dx%d",r.W,r.H);
+        std::printf("%-9s %-10s %7.3f %11.1f %11.1f %13.2f %11.2f %7.2fx  %s\n",step==defaultSampleStep?"constexpr":"cached",rs,step,ns[0]/frames/1e3,ns[1]/frames/1e3,
+            pts?ns[0]/(double)pts:0.0,pts?ns[1]/(double)pts:0.0,ns[1]>0?ns[0]/ns[1]:0.0,ok?"ok":"MISMATCH");
+    }
+    return failures;
+}
+
+// [RU] --- Меши: время загрузки (mmap + разбор + нормали) и треугольники/с при рендере сцены из экземпляров ---
+// [EN] --- Meshes: load time (mmap + parse + normals) and triangles/sec rendering an instanced scene ---
+// [RU] Без --model пишется синтетическая сфера в STL и OBJ: оба файла обязаны дать тот же кадр, tiled — тот же, что scanline.
+// [EN] Without --model a synthetic sphere is written as STL and OBJ: both files must give the same frame, tiled the same as scanline.
+static int benchMeshes(std::vector<std::string> models,size_t synthTris,int instances,int frames,const std::vector<Res>&res,
+                       const std::vector<int>&threadCounts,Renderer&renderer,RenderParams rp,float aspect){
+    std::vector<std::string> temps;
+    if(models.empty()){
+        if(!synthTris) return 0;
+        const Mesh sphere=bumpySphere(synthTris);
+        const std::filesystem::path dir=std::filesystem::temp_directory_path();
+        temps={(dir/"cube_bench_sphere.stl").string(),(dir/"cube_bench_sphere.obj").string()};
+        if(!saveStl(sphere,temps[0])||!saveObj(sphere,temps[1])){ std::printf("\nmesh: cannot write %s\n",dir.string().c_str()); return 1; }
+        models=temps;
+    }
+    int failures=0;
+    std::printf("\n%-28s %9s %10s %10s %9s %9s %9s\n","model","MB","tris","verts","load ms","MB/s","Mtris/s");
+    std::vector<Mesh> meshes(models.size());
+    for(size_t i=0;i<models.size();++i){
+        std::string err; auto t0=std::chrono::steady_clock::now();
+        if(!loadMesh(models[i].c_str(),meshes[i],err)){ std::printf("%-28s %s\n",models[i].c_str(),err.c_str()); ++failures; continue; }
+        const double ms=(double)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now()-t0).count()/1e3;
+        meshes[i].fitUnit();
+        const double mb=(double)std::filesystem::file_size(models[i])/1048576.0;
+        std::string name=std::filesystem::path(models[i]).filename().string();
+        std::printf("%-28s %9.1f %10zu %10zu %9.1f %9.0f %9.2f\n",name.c_str(),mb,meshes[i].tris(),meshes[i].pos.size(),ms,mb/(ms/1e3),(double)meshes[i].tris()/(ms*1e3));
+    }
+    for(const std::string&t:temps) std::filesystem::remove(t);
+    if(failures) return failures;
+
+    std::printf("\n%-28s %-9s %3s %-10s %12s %8s %12s %7s %10s %9s  %-16s %s\n","scene","mode","thr","res","tris/frame","culled %","prims/frame","frames","ms/frame","Mtris/s","checksum","match");
+    std::vector<uint64_t> ref(res.size(),0);   // [RU] Сумма scanline первой модели на разрешение
+                                               // [EN] First model's scanline checksum per resolution
+    for(size_t mi=0;mi<meshes.size();++mi){
+        Scene sc; sc.grid({&meshes[mi]},instances);
+        std::string name=std::filesystem::path(models[mi]).filename().string()+" x"+std::to_string(instances);
+        for(size_t ri=0;ri<res.size();++ri){ const Res&r=res[ri];
+            Projector proj(Geom{r.W,r.H,aspect}); Frame frame; frame.resize(r.W,r.H);
+            uint64_t scanSum=0;
+            for(int pass=0;pass<=(int)threadCounts.size();++pass){ // [RU] Проход 0 — scanline, далее tiled по числу потоков
+                                                                   // [EN] Pass 0 — scanline, then tiled per thread count
+                rp.mode = pass ? RasterMode::Tiled : RasterMode::Scanline;
+                const int thr = pass ? threadCounts[(size_t)pass-1] : 1; renderer.tiled.setThreads(thr);
+                renderer.render(frame,proj,rp,sc,0.0f,1.0f); // [RU] Прогрев
+                                                             // [EN] Warm-up
+                uint64_t sum=1469598103934665603ull; double total=0;
+                const MeshRaster&mr=renderer.meshes; const uint64_t sub0=mr.submitted, cul0=mr.culled, emi0=mr.emitted; // [RU] Счётчики setup — только за замер
+                                                                                                                           // [EN] Setup counters — over the timed frames only
+                for(int i=0;i<frames;++i){
+                    auto f0=std::chrono::steady_clock::now();
+                    renderer.render(frame,proj,rp,sc,(float)i/60.0f,1.0f);
+                    total+=(double)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now()-f0).count();
+                    sum=frameChecksum(frame,sum);
+                }
+                if(!pass){ scanSum=sum; if(!mi) ref[ri]=sum; }
+                const bool ok = sum==scanSum && (temps.empty()||sum==ref[ri]); // [RU] STL и OBJ одной сферы — один кадр
+                                                                               // [EN] STL and OBJ of one sphere — one frame
+                if(!ok) ++failures;
+                const uint64_t sub=mr.submitted-sub0; // [RU] Доля отброшенных задних граней и примитивов, дошедших до заливки
+                                                      // [EN] Share of back faces culled and primitives that reach the fill
+                const double culledPct = sub ? 100.0*(double)(mr.culled-cul0)/(double)sub : 0.0;
+                char rs[32]; std::snprintf(rs,sizeof rs,"%dx%d",r.W,r.H);
+                std::printf("%-28s %-9s %3d %-10s %12zu %8.1f %12llu %7d %10.2f %9.2f  %016llx %s\n",name.c_str(),rasterModeName(rp.mode),thr,rs,sc.tris(),
+                    culledPct,(unsigned long long)((mr.emitted-emi0)/(uint64_t)frames),frames,total/frames/1e6,(double)sc.tris()*frames/(total/1e3),(unsigned long long)sum,ok?"ok":"MISMATCH");
+            }
+        }
+    }
+    if(meshes.size()>1&&!res.empty()){          // [RU] Все модели одной сценой, как cube с несколькими --model: каждая обязана дойти до кадра
+                                               // [EN] All models as one scene, like cube with several --model: each must reach the frame
+        std::vector<const Mesh*> ms; for(const Mesh&m:meshes) ms.push_back(&m);
+        Scene sc; sc.grid(ms,1);               // [RU] Просим один экземпляр — сетка всё равно ставит по одному на модель
+                                               // [EN] Ask for one instance — the grid still places one per model
+        const Res&r=res.front(); Projector proj(Geom{r.W,r.H,aspect}); Frame frame; frame.resize(r.W,r.H);
+        rp.mode=RasterMode::Scanline; renderer.render(frame,proj,rp,sc,0.0f,1.0f);
+        size_t seen=0;                         // [RU] Экземпляр виден, если в кадре есть ячейка его цвета
+                                               // [EN] An instance is visible if the frame holds a cell of its color
+        for(const Instance&it:sc.items){ bool hit=false;
+            for(size_t k=0;k<(size_t)r.W*(size_t)r.H&&!hit;++k){ const Cell c=frame.at(k); hit = c.ch!=' '&&c.attr==it.attr; }
+            seen+=hit; }
+        const bool ok = sc.items.size()==meshes.size() && seen==meshes.size();
+        if(!ok) ++failures;
+        std::printf("\n%-28s %7s %10s %9s  %s\n","multi-model scene","models","instances","in frame","match");
+        std::printf("%-28s %7zu %10zu %9zu  %s\n","all --model files",meshes.size(),sc.items.size(),seen,ok?"ok":"MISSING");
+    }
+    return failures;
+}
+
+// [RU] --- Запись: цена для потока рендера (reclaim + submit) и побитная сверка воспроизведения с отрисованными кадрами ---
+// [EN] --- Recording: cost to the render thread (reclaim + submit) and a bit-exact check of replay against the rendered frames ---
+// [RU] Кадры идут в темпе 120 Гц, как в cube: писатель работает в паузах, а меряется только время потока рендера.
+// [RU] Блоки без записи и с записью чередуются на одних и тех же позах, так что шум машины достаётся обоим поровну.
+// [RU] Медиана записи сверх бюджета (5%, но не меньше 1 мкс) — провал; перед провалом замер повторяется до трёх раз.
+// [RU] Пропущенные кадры не ошибка — они видны в dropped; сверяется каждый записанный.
+// [EN] Frames are paced at 120 Hz, as in cube: the writer works in the gaps, and only render-thread time is measured.
+// [EN] Blocks without and with recording alternate over the same poses, so machine noise hits both alike.
+// [EN] A recording median over budget (5%, but at least 1 us) fails; the measurement is retried up to three times first.
+// [EN] Dropped frames are not an error — they show up in dropped; every written one is checked.
+static int benchRecord(const std::vector<Res>&res,int frames,int thr,Renderer&renderer,RenderParams rp,float aspect){
+    const auto period=std::chrono::microseconds(8333);
+    const int recWarmup=4, block=8, tries=3;   // [RU] Кадров прогрева; длина блока с записью/без; попыток уложиться в бюджет
+                                               // [EN] Warm-up frames; length of a block with/without recording; attempts to meet the budget
+    const double budgetPct=5.0, budgetUs=1.0;
+    const std::string path=(std::filesystem::temp_directory_path()/"cube_bench.rec").string();
+    std::printf("\n%-9s %3s %-10s %10s %10s %9s %5s %9s %9s %9s  %s\n","record","thr","res","p50 us","rec p50","overhead","tries","written","dropped","B/frame","replay");
+    int failures=0;
+    if(frames<1) return 0;
+    rp.mode=RasterMode::Tiled; renderer.tiled.setThreads(thr);
+    for(const Res&r:res) for(int attempt=1;;++attempt){
+        Projector proj(Geom{r.W,r.H,aspect}); Frame frame; frame.resize(r.W,r.H);
+        std::vector<uint64_t> sums;            // [RU] Контрольная сумма каждого отданного кадра по его seq
+                                               // [EN] Checksum of every submitted frame by its seq
+        sums.reserve((size_t)frames+recWarmup);
+        std::vector<double> ns[2]; ns[0].reserve((size_t)frames); ns[1].reserve((size_t)frames); // [RU] 0 — без записи, 1 — с записью
+                                                                                                  // [EN] 0 — without recording, 1 — with it
+        Recorder recd; if(!recd.open(path.c_str())){ std::printf("record: cannot create %s\n",path.c_str()); return failures+1; }
+        auto next=std::chrono::steady_clock::now();
+        for(int i=0;i<recWarmup;++i){          // [RU] Прогрев, заодно буферы писателя (первое касание страниц)
+                                               // [EN] Warm-up, the writer's buffers included (first touch of pages)
+            std::this_thread::sleep_until(next+=period);
+            recd.reclaim(); renderer.render(frame,proj,rp,Pose::at(0.0f,1.0f));
+            sums.push_back(frameChecksum(frame,1469598103934665603ull)); recd.submit(frame,0); }
+        for(int i=0;i<2*frames;++i){
+            const int on=(i/block)&1, pose=i/(2*block)*block+i%block; // [RU] Блок с записью повторяет позы блока без неё
+                                                                        // [EN] A recording block repeats the poses of the block without it
+            std::this_thread::sleep_until(next+=period);
+            if(!on) recd.reclaim();            // [RU] Хвост блока записи — вне замера
+                                               // [EN] The tail of a recording block — outside timing
+            auto f0=std::chrono::steady_clock::now();
+            if(on) recd.reclaim();             // [RU] Вся цена записи для рендера: reclaim + submit
+                                               // [EN] Recording's whole cost to the renderer: reclaim + submit
+            renderer.render(frame,proj,rp,Pose::at((float)pose/60.0f,1.0f));
+            auto f1=std::chrono::steady_clock::now();
+            if(on){ const uint64_t h=frameChecksum(frame,1469598103934665603ull); // [RU] Хеш вне замера
+                                                                                  // [EN] Hashing outside timing
+                auto s0=std::chrono::steady_clock::now(); recd.submit(frame,(uint64_t)i*8333333ull); f1+=std::chrono::steady_clock::now()-s0;
+                sums.push_back(h); }
+            ns[on].push_back((double)std::chrono::duration_cast<std::chrono::nanoseconds>(f1-f0).count());
+        }
+        recd.flush(); recd.close();
+        const double base=percentile(ns[0],0.50)/1e3, rec=percentile(ns[1],0.50)/1e3; // [RU] Медианы — одиночные вытеснения писателем не решают
+                                                                                      // [EN] Medians — occasional preemption by the writer does not dominate
+        const bool inBudget = rec-base <= std::max(budgetUs,base*budgetPct/100.0);
+        ReplayReader rd; std::string err; int bad=0, got=0, rr=0;
+        if(rd.open(path.c_str(),err)) while((rr=rd.next(err))==1){ ++got;
+            rd.toFrame(frame); if(rd.seq>=sums.size()||frameChecksum(frame,1469598103934665603ull)!=sums[rd.seq]) ++bad; }
+        const bool ok = rr==0 && !bad && !recd.failed.load() && (uint64_t)got==recd.written.load();
+        if(ok&&!inBudget&&attempt<tries) continue; // [RU] Возможно, шум — меряем ещё раз
+                                                    // [EN] Possibly noise — measure again
+        if(!ok||!inBudget) ++failures;
+        const uint64_t w=recd.written.load();
+        char rs[32]; std::snprintf(rs,sizeof rs,"%dx%d",r.W,r.H);
+        std::printf("%-9s %3d %-10s %10.1f %10.1f %8.1f%% %5d %9llu %9llu %9.0f  %s\n","tiled",thr,rs,base,rec,base>0?(rec-base)/base*100.0:0.0,attempt,
+            (unsigned long long)w,(unsigned long long)recd.dropped.load(),w?(double)recd.bytes.load()/(double)w:0.0,
+            !ok?(rr<0?err.c_str():"MISMATCH"):inBudget?"ok":"OVER BUDGET");
+        break;
+    }
+    std::filesystem::remove(path);
+    return failures;
+}
+
+// [RU] Scanline и tiled на кадрах с отсечёнными углами: эталон scanline, tiled обязан совпасть побитно
+// [EN] Scanline and tiled on frames with clipped corners: a scanline golden, tiled must match it bit for bit
+static int benchNearPlane(Renderer&renderer,RenderParams rp,float aspect,int thr,bool canCheck){
+    std::printf("\n%-9s %3s %-10s %6s %7s  %-16s %s\n","near","thr","res","scale","frames","checksum","golden");
+    int failures=0;
+    for(const NearGolden&gd:nearGoldens) for(RasterMode mode:{RasterMode::Scanline,RasterMode::Tiled}){
+        rp.mode=mode; rp.cubeScale=gd.scale; renderer.tiled.setThreads(mode==RasterMode::Tiled?thr:1);
+        HeadlessTarget target(gd.W,gd.H,aspect); Geom g=target.geom(); Projector proj(g); Frame frame; frame.resize(g.W,g.H);
+        uint64_t sum=1469598103934665603ull;
+        for(int i=0;i<gd.frames;++i){ renderer.render(frame,proj,rp,Pose::at((float)i/60.0f,1.0f)); sum=frameChecksum(frame,sum); }
+        const char*verdict="-";
+        if(canCheck){ verdict = sum==gd.sum ? "ok" : "MISMATCH"; if(sum!=gd.sum) ++failures; }
+        char rs[32]; std::snprintf(rs,sizeof rs,"%dx%d",gd.W,gd.H);
+        std::printf("%-9s %3d %-10s %6.1f %7d  %016llx %s\n",rasterModeName(mode),mode==RasterMode::Tiled?thr:1,rs,gd.scale,gd.frames,(unsigned long long)sum,verdict);
+    }
+    return failures;
+}
+
+static void usage(){
+    std::printf("usage: bench [--frames N] [--res WxH]... [--step S] [--aspect A] [--mode sampler|scanline|batch|tiled|all] [--isa auto|scalar|sse2|avx2]\n"
+                "             [--threads N[,N...]] [--tile WxH] [--speed S] [--model FILE]... [--mesh-tris N] [--instances N] [--mesh-frames N]\n"
+                "             [--rec-frames N]\n");
+}
+
+int main(int argc,char**argv){
+    int frames=240;                            // [RU] Кадров на разрешение
+                                               // [EN] Frames per resolution
+    RenderParams rp;                           // [RU] Те же параметры сцены, что у cube.exe
+                                               // [EN] Same scene parameters as cube.exe
+    float aspect=2.0f;                         // [RU] Типичный aspect глифа консоли
+                                               // [EN] Typical console glyph aspect
+    float speed=1.0f;                          // [RU] Множитель скорости вращения (медленно → меньше байт)
+                                               // [EN] Rotation speed multiplier (slower → fewer bytes)
+    std::vector<Res> res;
+    const std::vector<RasterMode> allModes={RasterMode::Sampler,RasterMode::Scanline,RasterMode::Batch,RasterMode::Tiled};
+    std::vector<RasterMode> modes=allModes;    // [RU] По умолчанию — все для сравнения
+                                               // [EN] All of them by default, for comparison
+    Renderer renderer;                         // [RU] Состояние рендера между кадрами
+                                               // [EN] Renderer state across frames
+    std::vector<int> threadCounts={1};         // [RU] Ряд потоков для tiled: 1 … все ядра — график масштабирования
+                                               // [EN] Thread counts for tiled: 1 … all cores — a scaling chart
+    std::vector<std::string> models;           // [RU] STL/OBJ для замера загрузки; пусто — синтетическая сфера
+                                               // [EN] STL/OBJ to time loading; empty — the synthetic sphere
+    size_t meshTris=1u<<20;                    // [RU] Размер синтетической сферы (0 — без мешей)
+                                               // [EN] Synthetic sphere size (0 — no meshes)
+    int instances=1, meshFrames=20;
+    int recFrames=120;                         // [RU] Кадров на разрешение в замере записи (1 с на проход при 120 Гц)
+                                               // [EN] Frames per resolution in the recording run (1 s per pass at 120 Hz)
+    const int hw=(int)std::max(1u,std::thread::hardware_concurrency());
+    if(hw>1) threadCounts.push_back(hw);
+    for(int i=1;i<argc;++i){
+        if(!std::strcmp(argv[i],"--frames")&&i+1<argc) frames=std::max(1,std::atoi(argv[++i]));
+        else if(!std::strcmp(argv[i],"--step")&&i+1<argc) rp.step=(float)std::atof(argv[++i]);
+        else if(!std::strcmp(argv[i],"--aspect")&&i+1<argc) aspect=(float)std::atof(argv[++i]);
+        else if(!std::strcmp(argv[i],"--speed")&&i+1<argc) speed=(float)std::atof(argv[++i]);
+        else if(!std::strcmp(argv[i],"--mode")&&i+1<argc){ RasterMode m; ++i;
+            if(!std::strcmp(argv[i],"all")) modes=allModes;
+            else if(parseRasterMode(argv[i],m)) modes={m}; else { usage(); return 2; } }
+        else if(!std::strcmp(argv[i],"--isa")&&i+1<argc){ if(!parseIsa(argv[++i],renderer.batch.isa)){ usage(); return 2; } }
+        else if(!std::strcmp(argv[i],"--threads")&&i+1<argc){ threadCounts.clear();
+            for(char*tok=std::strtok(argv[++i],",");tok;tok=std::strtok(nullptr,",")) threadCounts.push_back(std::max(1,std::atoi(tok))); }
+        else if(!std::strcmp(argv[i],"--tile")&&i+1<argc){ if(std::sscanf(argv[++i],"%dx%d",&renderer.tiled.tileW,&renderer.tiled.tileH)!=2||renderer.tiled.tileW<1||renderer.tiled.tileH<1){ usage(); return 2; } }
+        else if(!std::strcmp(argv[i],"--model")&&i+1<argc) models.push_back(argv[++i]);
+        else if(!std::strcmp(argv[i],"--mesh-tris")&&i+1<argc) meshTris=(size_t)std::strtoull(argv[++i],nullptr,10);
+        else if(!std::strcmp(argv[i],"--instances")&&i+1<argc) instances=std::max(1,std::atoi(argv[++i]));
+        else if(!std::strcmp(argv[i],"--mesh-frames")&&i+1<argc) meshFrames=std::max(1,std::atoi(argv[++i]));
+        else if(!std::strcmp(argv[i],"--rec-frames")&&i+1<argc) recFrames=std::max(0,std::atoi(argv[++i]));
+        else if(!std::strcmp(argv[i],"--res")&&i+1<argc){ Res r{}; if(std::sscanf(argv[++i],"%dx%d",&r.W,&r.H)!=2||r.W<1||r.H<1){ usage(); return 2; } res.push_back(r); }
+        else { usage(); return 2; }
+    }
+    if(res.empty()) for(const Golden&gd:goldens) if(gd.mode==RasterMode::Sampler) res.push_back({gd.W,gd.H}); // [RU] 80x25 … 1000x400
+                                                                                                              // [EN] 80x25 … 1000x400
+    const bool canCheck = rp.step==RenderParams{}.step && aspect==2.0f && speed==1.0f; // [RU] Эталоны действительны только для дефолтов
+                                                                        // [EN] Goldens are valid only for defaults
+                                                                        // [RU] (шаг влияет только на сэмплер, но не усложняем)
+                                                                        // [EN] (the step only affects the sampler, but keep it simple)
+
+    std::printf("%-9s %3s %-10s %7s %10s %12s %10s %10s %9s %9s %7s  %-16s %s\n","mode","thr","res","frames","fps","ns/frame","p50 us","p99 us","full B","ansi B/f","allocs","checksum","golden");
+    int failures=0;
+    std::vector<TraceRow> traceRows;
+    for(RasterMode mode:modes) for(int thr:threadCounts) for(const Res&r:res){
+        if(mode!=RasterMode::Tiled&&thr!=threadCounts.front()) continue; // [RU] Потоки влияют только на tiled
+                                                                          // [EN] Threads only matter for tiled
+        rp.mode=mode; renderer.tiled.setThreads(mode==RasterMode::Tiled?thr:1);
+        HeadlessTarget target(r.W,r.H,aspect); // [RU] Кадр в памяти нужного размера
+                                               // [EN] In-memory frame of the requested size
+        Geom g=target.geom(); Projector proj(g);
+        Frame frame; frame.resize(g.W,g.H);
+        for(int i=0;i<8;++i) renderer.render(frame,proj,rp,Pose::at((float)i/60.0f,speed)); // [RU] Прогрев кешей
+                                                                                      // [EN] Warm up caches
+
+        std::vector<double> ns((size_t)frames);
+        uint64_t sum=1469598103934665603ull;   // [RU] Сумма по всей последовательности кадров
+                                               // [EN] Checksum over the whole frame sequence
+        AnsiEncoder enc; std::string ansi; size_t fullBytes=0; // [RU] Первый кадр — полная перерисовка, далее дельты
+                                                               // [EN] First frame is a full redraw, then deltas
+        ansi.reserve((size_t)r.W*(size_t)r.H*16); target.present(frame); // [RU] Буферы вывода — до замера, как у терминала после первого кадра
+        enc.encode(frame,ansi); enc.invalidate(); enc.frames=enc.bytes=0; ansi.clear(); // [EN] Output buffers — before measuring, like a terminal after its first frame
+        TraceRow tr{mode,mode==RasterMode::Tiled?thr:1,r,{}}; traceTotals(tr.count);
+        const uint64_t allocs0=heapAllocs.load();
+        for(int i=0;i<frames;++i){
+            auto f0=std::chrono::steady_clock::now();
+            renderer.render(frame,proj,rp,Pose::at((float)i/60.0f,speed)); // [RU] Фиксированная последовательность углов: 60 Гц
+                                                                     // [EN] Fixed angle sequence: 60 Hz
+            target.present(frame);
+            auto f1=std::chrono::steady_clock::now();
+            ns[(size_t)i]=(double)std::chrono::duration_cast<std::chrono::nanoseconds>(f1-f0).count();
+            sum=frameChecksum(frame,sum);      // [RU] Вне замера — хеш не часть рендера
+                                               // [EN] Outside timing — hashing is not part of rendering
+            ansi.clear(); enc.encode(frame,ansi); if(i==0) fullBytes=ansi.size(); // [RU] Столько ушло бы в терминал
+                                                                                  // [EN] This is what a terminal would receive
+        }
+        const uint64_t allocs=heapAllocs.load()-allocs0; // [RU] Рендер + вывод + ANSI за все кадры: должно быть 0
+                                                         // [EN] Render + present + ANSI over all frames: must be 0
+        if(traceEnabled()){ uint64_t c[TC_COUNT]; traceTotals(c); for(int k=0;k<TC_COUNT;++k) tr.count[k]=c[k]-tr.count[k]; traceRows.push_back(tr); }
+        double total=0; for(double x:ns) total+=x;
+
+        const char*verdict="-";
+        const RasterMode gm = mode==RasterMode::Tiled ? RasterMode::Scanline : mode; // [RU] Тайлы обязаны совпасть со scanline побитно
+                                                                                     // [EN] Tiles must match scanline bit for bit
+        if(canCheck) for(const Golden&gd:goldens) if(gd.mode==gm&&gd.W==r.W&&gd.H==r.H&&gd.frames==frames){
+            verdict = gd.sum==sum ? "ok" : "MISMATCH"; if(gd.sum!=sum) ++failures; }
+        if(allocs){ verdict="ALLOC"; ++failures; } // [RU] Аллокация в установившемся режиме — тоже регрессия
+                                                   // [EN] An allocation in steady state is a regression too
+        char rs[32]; std::snprintf(rs,sizeof rs,"%dx%d",r.W,r.H);
+        const double deltaBytes = frames>1 ? (double)(enc.bytes-fullBytes)/(frames-1) : (double)fullBytes;
+        std::printf("%-9s %3d %-10s %7d %10.1f %12.0f %10.2f %10.2f %9zu %9.0f %7llu  %016llx %s\n",rasterModeName(mode),mode==RasterMode::Tiled?thr:1,rs,frames,
+            1e9*frames/total,total/frames,percentile(ns,0.50)/1e3,percentile(ns,0.99)/1e3,fullBytes,deltaBytes,(unsigned long long)allocs,(unsigned long long)sum,verdict);
+    }
+    if(!traceRows.empty()){                    // [RU] Сколько работы на кадр тратится впустую — по режимам
+                                               // [EN] How much per-frame work is wasted — by mode
+        std::printf("\n%-9s %3s %-10s %11s %11s %11s %11s %11s %9s\n","trace","thr","res","samples/f","near/f","screen/f","zrej/f","written/f","overdraw");
+        for(const TraceRow&t:traceRows){ char rs[32]; std::snprintf(rs,sizeof rs,"%dx%d",t.r.W,t.r.H);
+            const double f=(double)frames;
+            std::printf("%-9s %3d %-10s %11.0f %11.0f %11.0f %11.0f %11.0f %9.3f\n",rasterModeName(t.mode),t.thr,rs,t.count[TC_SAMPLES]/f,t.count[TC_NEAR]/f,
+                t.count[TC_SCREEN]/f,t.count[TC_ZREJECT]/f,t.count[TC_WRITTEN]/f,t.count[TC_WRITTEN]?(double)t.count[TC_OVERDRAW]/(double)t.count[TC_WRITTEN]:0.0);
+        }
+    }
+    failures+=benchNearPlane(renderer,rp,aspect,threadCounts.back(),canCheck);
+    failures+=benchKernels(1u<<20,20);         // [RU] 1M точек × 20 повторов
+                                               // [EN] 1M points × 20 repeats
+    failures+=benchSampler(res,frames,rp,aspect); // [RU] Исходный цикл против табличного, те же кадры и разрешения
+                                                  // [EN] Original loop vs the table-driven one, same frames and resolutions
+    failures+=benchRecord(res,recFrames,threadCounts.back(),renderer,rp,aspect);
+    failures+=benchMeshes(models,meshTris,instances,meshFrames,res,threadCounts,renderer,rp,aspect);
+    return failures?1:0;                       // [RU] Несовпадение с эталоном — ненулевой код выхода
+                                               // [EN] A golden mismatch yields a non-zero exit code
+}
@@ -1,18 +1,49 @@
 // [RU] === cube.cpp — фронтальные грани, ambient+diffuse, корректная проекция по реальному шрифту ===
 // [EN] === cube.cpp — front faces, ambient+diffuse, correct projection using actual console font metrics ===
+#ifdef _WIN32
 #include <windows.h>                           // [RU] Доступ к геометрии консоли и прямому выводу в буфер
                                                // [EN] Access to console geometry and direct writes to the screen buffer
+#else
+#include <termios.h>                           // [RU] Raw-режим терминала
+                                               // [EN] Terminal raw mode
+#include <sys/ioctl.h>                         // [RU] TIOCGWINSZ — размер окна
+                                               // [EN] TIOCGWINSZ — window size
+#include <unistd.h>                            // [RU] read/write
+                                               // [EN] read/write
+#include <signal.h>                            // [RU] SIGWINCH вместо опроса размера каждый кадр
+                                               // [EN] SIGWINCH instead of polling the size every frame
+#include <poll.h>                              // [RU] Ожидание ввода с таймаутом в потоке ввода
+                                               // [EN] Waiting for input with a timeout on the input thread
+#include <cerrno>
+#include "ansi.h"                              // [RU] Дельта-кодировщик ANSI
+                                               // [EN] ANSI delta encoder
+#endif
+#include "pipeline.h"                          // [RU] Переносимое ядро: грани, z-буфер, затенение, растеризаторы
+                                               // [EN] Portable core: faces, z-buffer, shading, rasterizers
+#include <cstdio>                              // [RU] Сообщение об ошибке аргументов
+                                               // [EN] Argument error message
+#include <cstdlib>                             // [RU] atoi/atof
+                                               // [EN] atoi/atof
+#include "frame_sched.h"                       // [RU] Планировщик кадров, поток ввода, гистограммы
+                                               // [EN] Frame scheduler, input thread, histograms
+#include "record.h"                            // [RU] --record / --replay / --cast
+                                               // [EN] --record / --replay / --cast
 #include <vector>                              // [RU] Плоские буферы под символы и глубину
                                                // [EN] Flat buffers for characters and depth
 #include <chrono>                              // [RU] Стендартный таймер для плавной анимации
                                                // [EN] Standard timer for smooth animation
-#include <thread>                              // [RU] Сон между кадрами ~60 FPS
-                                               // [EN] Sleep between frames ~60 FPS
+#include <thread>                              // [RU] Пауза, пока окно слишком мало
+                                               // [EN] Pause while the window is too small
 #include <cmath>                               // [RU] Тригонометрия и корни
                                                // [EN] Trigonometry and square roots
 #include <algorithm>                           // [RU] clamp/fill — аккуратная работа с массивами
                                                // [EN] clamp/fill — tidy array handling
 
+// [RU] --- Клавиши как события: платформа сама решает, как их добыть ---
+// [EN] --- Keys as events: each platform decides how to obtain them ---
+enum class Key{ Plus, Minus, Slower, Faster, Quit };
+
+#ifdef _WIN32
 // [RU] --- RAII: прячем курсор на время демо ---
 // [EN] --- RAII: hide the cursor for the duration of the demo ---
 struct ConsoleCursorGuard{                     // [RU] Гарант возвращения среды пользователю «как было»
@@ -27,54 +58,23 @@ struct ConsoleCursorGuard{                     // [RU] Гарант возвра
                                                             // [EN] Restore cursor on exit
 };
 
-// [RU] --- Мини-алгебра 3D ---
-// [EN] --- Tiny 3D algebra ---
-struct Vec3{ float x,y,z; };                   // [RU] Компактный контейнер координат
-                                               // [EN] Compact coordinate container
-static inline Vec3 add(const Vec3&a,const Vec3&b){return {a.x+b.x,a.y+b.y,a.z+b.z};} // [RU] Сумма — для сдвига сцены
-                                                                                     // [EN] Sum — used for translating the scene
-static inline Vec3 mul(const Vec3&a,float s){return {a.x*s,a.y*s,a.z*s};}            // [RU] Масштаб — удобно для нормалей
-                                                                                     // [EN] Scale — handy for normals
-static inline float dot(const Vec3&a,const Vec3&b){return a.x*b.x+a.y*b.y+a.z*b.z;}  // [RU] Скалярное — основа освещения
-                                                                                     // [EN] Dot product — basis for lighting
-static inline Vec3 norm(const Vec3&a){float m=std::sqrt(dot(a,a)+1e-9f);return {a.x/m,a.y/m,a.z/m};} // [RU] Нормализация с защитой
-                                                                                                     // [EN] Normalization with a safety guard
-
-// [RU] --- Повороты вокруг осей + композиция ---
-// [EN] --- Rotations around axes + composition ---
-static inline Vec3 rotX(const Vec3&p,float s,float c){return {p.x, c*p.y - s*p.z, s*p.y + c*p.z};}   // [RU] Вращение X
-                                                                                                     // [EN] Rotation around X
-static inline Vec3 rotY(const Vec3&p,float s,float c){return { c*p.x + s*p.z, p.y, -s*p.x + c*p.z};} // [RU] Вращение Y
-                                                                                                     // [EN] Rotation around Y
-static inline Vec3 rotZ(const Vec3&p,float s,float c){return { c*p.x - s*p.y, s*p.x + c*p.y, p.z};}  // [RU] Вращение Z
-                                                                                                     // [EN] Rotation around Z
-static inline Vec3 rotateAll(const Vec3&p,float sx,float cx,float sy,float cy,float sz,float cz){    // [RU] Композиция Z→X→Y
-                                                                                                     // [EN] Composition Z→X→Y
-    return rotY(rotX(rotZ(p,sz,cz),sx,cx),sy,cy);                                                     // [RU] Порядок выбран ради живой динамики
-                                                                                                      // [EN] Order chosen for lively motion
-}
-
-// [RU] --- Параметризация граней куба ---
-// [EN] --- Cube face parameterization ---
-struct Face{ Vec3 axis; float sign; };         // [RU] axis — какая координата фиксируется; sign — какая из двух сторон
-                                               // [EN] axis — which coordinate is fixed; sign — which of the two sides
-static const Face cubeFaces[6]={
-    {{1,0,0},+1}, {{1,0,0},-1},                // [RU] X=±1
-                                               // [EN] X=±1
-    {{0,1,0},+1}, {{0,1,0},-1},                // [RU] Y=±1
-                                               // [EN] Y=±1
-    {{0,0,1},+1}, {{0,0,1},-1},                // [RU] Z=±1
-                                               // [EN] Z=±1
+// [RU] --- Системный таймер 1 мс на время сессии: без него Sleep и sleep_until квантуются по ~15.6 мс ---
+// [EN] --- A 1 ms system timer for the session: without it Sleep and sleep_until are quantized to ~15.6 ms ---
+struct TimerResolutionGuard{                   // [RU] winmm грузится на лету — сборке не нужен -lwinmm
+                                               // [EN] winmm is loaded at run time — the build needs no -lwinmm
+    typedef UINT (WINAPI*PeriodFn)(UINT);
+    HMODULE winmm = LoadLibraryA("winmm.dll");
+    PeriodFn endPeriod = nullptr;              // [RU] Не nullptr — период поднят и его надо вернуть
+                                               // [EN] Non-null — the period was raised and must be restored
+    TimerResolutionGuard(){
+        if(!winmm) return;
+        PeriodFn begin=reinterpret_cast<PeriodFn>(reinterpret_cast<void*>(GetProcAddress(winmm,"timeBeginPeriod")));
+        PeriodFn end=reinterpret_cast<PeriodFn>(reinterpret_cast<void*>(GetProcAddress(winmm,"timeEndPeriod")));
+        if(begin&&end&&begin(1)==0) endPeriod=end; // [RU] 0 — TIMERR_NOERROR
+                                                   // [EN] 0 — TIMERR_NOERROR
+    }
+    ~TimerResolutionGuard(){ if(endPeriod) endPeriod(1); if(winmm) FreeLibrary(winmm); }
 };
-static inline Vec3 pointOnFace(const Face&f,float u,float v){ // [RU] Генерация точки (u,v)∈[-1,1]² на выбранной грани
-                                                              // [EN] Generate point (u,v)∈[-1,1]² on the chosen face
-    if(f.axis.x) return { f.sign, u, v };       // [RU] На X-гранях фиксируем X
-                                                // [EN] On X-faces we fix X
-    if(f.axis.y) return { u, f.sign, v };       // [RU] На Y-гранях фиксируем Y
-                                                // [EN] On Y-faces we fix Y
-    return { u, v, f.sign };                    // [RU] На Z-гранях фиксируем Z
-                                                // [EN] On Z-faces we fix Z
-}
 
 // [RU] --- Геометрия консоли и форма символа (пиксели) ---
 // [EN] --- Console geometry and character shape (pixels) ---
@@ -99,194 +99,362 @@ static ConsoleGeom queryConsoleGeom(HANDLE h){  // [RU] Свежая метри
                                                                                                                     // [EN] The rest — as is
 }
 
-// [RU] --- Проектор с учётом реального aspect символа ---
-// [EN] --- Projector accounting for the real character aspect ratio ---
-struct Projector{ int W,H; float fx,fy;        // [RU] W/H — символы; fx/fy — фокальные масштабы по осям
-                                               // [EN] W/H — characters; fx/fy — focal scales along axes
-    explicit Projector(const ConsoleGeom&g){ W=g.winW; H=g.winH; fx=W*0.60f; fy=fx/g.charAspect; } // [RU] Баланс ширины/высоты
-                                                                                                   // [EN] Balance width/height
-    bool toScreen(const Vec3&p,int&sx,int&sy)const{ if(p.z<=0.001f) return false; float invz=1.0f/p.z; // [RU] Стабильная перспектива
-                                                                                                       // [EN] Stable perspective
-        float x=p.x*invz, y=p.y*invz; sx=(int)(x*fx+W*0.5f); sy=(int)(-y*fy+H*0.5f);                 // [RU] Центрируем и масштабируем
-                                                                                                     // [EN] Center and scale
-        return (unsigned)sx<(unsigned)W && (unsigned)sy<(unsigned)H; }                                // [RU] Быстрая проверка границ
-                                                                                                      // [EN] Fast bounds check
+// [RU] --- Консольная цель: геометрия окна + прямой blit в видимое окно с цветами ---
+// [EN] --- Console target: window geometry + direct blit into the visible window with colors ---
+struct ConsoleTarget : RenderTarget{
+    HANDLE h;                                   // [RU] Дескриптор консоли
+                                                // [EN] Console handle
+    ConsoleGeom g{};                            // [RU] Последняя снятая геометрия (нужны winL/winT)
+                                                // [EN] Last queried geometry (winL/winT are needed)
+    std::vector<CHAR_INFO> out;                 // [RU] Кадр в формате WinAPI — переиспользуется
+                                                // [EN] Frame in WinAPI layout — reused
+    explicit ConsoleTarget(HANDLE h_):h(h_){}
+    Geom geom() override { g=queryConsoleGeom(h); return {g.winW,g.winH,g.charAspect}; } // [RU] Адаптация к ресайзу/смене шрифта
+                                                                                         // [EN] Adapt to resize/font change
+    void present(const Frame&fr) override {     // [RU] Пишем построчно с символами и атрибутами
+                                                // [EN] Write line-by-line with characters and attributes
+        out.resize(fr.size());
+        for(size_t i=0;i<fr.size();++i){ const Cell c=fr.at(i); out[i].Char.AsciiChar=c.ch; out[i].Attributes=c.attr; }
+        COORD bufSize = {(SHORT)fr.W, (SHORT)fr.H};
+        COORD bufCoord = {0, 0};
+        SMALL_RECT writeRegion = {g.winL, g.winT, (SHORT)(g.winL + fr.W - 1), (SHORT)(g.winT + fr.H - 1)};
+        WriteConsoleOutputA(h, out.data(), bufSize, bufCoord, &writeRegion);
+    }
+};
+
+// [RU] --- Клавиши WinAPI: только нажатие, не удержание ---
+// [EN] --- WinAPI keys: on press only, not on hold ---
+struct KeyReader{
+    bool prev[5]{};                             // [RU] Состояния клавиш для обнаружения "нажатия"
+                                                // [EN] Key states to detect a "press"
+    int poll(Key*out,int max){                  // [RU] Возвращает число событий в out
+                                                // [EN] Returns the number of events in out
+        static const int vk[5]={VK_OEM_PLUS,VK_OEM_MINUS,VK_OEM_4,VK_OEM_6,VK_ESCAPE}; // [RU] + - [ ] ESC
+                                                                                        // [EN] + - [ ] ESC
+        static const Key ev[5]={Key::Plus,Key::Minus,Key::Slower,Key::Faster,Key::Quit};
+        int n=0;
+        for(int k=0;k<5;++k){ bool curr=GetAsyncKeyState(vk[k]) & 0x8000;
+            if(curr&&!prev[k]&&n<max) out[n++]=ev[k];
+            prev[k]=curr; }
+        return n;
+    }
+    int wait(Key*out,int max,int timeoutMs){    // [RU] Для потока ввода: опрос раз в 1 мс до таймаута
+                                                // [EN] For the input thread: poll every 1 ms until the timeout
+        for(int i=0;i<timeoutMs;++i){ int n=poll(out,max); if(n) return n; Sleep(1); }
+        return 0;
+    }
 };
 
-// [RU] --- Прямой blit в видимое окно с цветами ---
-// [EN] --- Direct blit into the visible window with colors ---
-static void blitFrame(HANDLE h,const ConsoleGeom&g,const std::vector<CHAR_INFO>&cbuf){ // [RU] Пишем построчно с символами и атрибутами
-                                                                                       // [EN] Write line-by-line with characters and attributes
-    COORD bufSize = {(SHORT)g.winW, (SHORT)g.winH};
-    COORD bufCoord = {0, 0};
-    SMALL_RECT writeRegion = {g.winL, g.winT, (SHORT)(g.winL + g.winW - 1), (SHORT)(g.winT + g.winH - 1)};
-    WriteConsoleOutputA(h, cbuf.data(), bufSize, bufCoord, &writeRegion);
+#else
+// [RU] --- POSIX-терминал: raw-режим, альтернативный экран, размер по SIGWINCH, вывод дельтами ANSI ---
+// [EN] --- POSIX terminal: raw mode, alternate screen, size via SIGWINCH, ANSI delta output ---
+static volatile sig_atomic_t termResized=1;     // [RU] 1 — размер надо перечитать (и на старте тоже)
+                                                // [EN] 1 — the size must be re-read (at startup too)
+static void onWinch(int){ termResized=1; }      // [RU] В обработчике сигнала — только флаг
+                                                // [EN] Only a flag inside the signal handler
+static void writeAll(int fd,const char*p,size_t n){ // [RU] Один write() на кадр; цикл — только на частичную запись
+                                                    // [EN] One write() per frame; the loop is only for partial writes
+    while(n){ ssize_t k=::write(fd,p,n); if(k<0){ if(errno==EINTR) continue; return; } p+=k; n-=(size_t)k; }
+}
+
+struct TermTarget : RenderTarget{
+    termios saved{};                            // [RU] Исходный режим терминала
+                                                // [EN] Original terminal mode
+    Geom g{80,24,2.0f};                         // [RU] Последний известный размер
+                                                // [EN] Last known size
+    AnsiEncoder enc;                            // [RU] Что уже на экране + статистика байт
+                                                // [EN] What is already on screen + byte statistics
+    std::string buf;                            // [RU] Байты кадра — переиспользуются
+                                                // [EN] Frame bytes — reused
+    TermTarget(){
+        tcgetattr(0,&saved); termios t=saved;
+        t.c_lflag&=~(tcflag_t)(ICANON|ECHO|ISIG|IEXTEN); // [RU] Побайтно, без эха; Ctrl-C приходит как байт
+                                                         // [EN] Byte-wise, no echo; Ctrl-C arrives as a byte
+        t.c_iflag&=~(tcflag_t)(IXON|ICRNL);
+        t.c_cc[VMIN]=0; t.c_cc[VTIME]=0;        // [RU] read() не блокирует
+                                                // [EN] read() does not block
+        tcsetattr(0,TCSANOW,&t);
+        struct sigaction sa{}; sa.sa_handler=onWinch; sigemptyset(&sa.sa_mask); sigaction(SIGWINCH,&sa,nullptr);
+        const char on[]="\x1b[?1049h\x1b[?25l";  // [RU] Альтернативный экран + скрыть курсор
+                                                // [EN] Alternate screen + hide the cursor
+        writeAll(1,on,sizeof on-1);
+    }
+    ~TermTarget(){                              // [RU] Возвращаем терминал «как было» и печатаем байты/кадр
+                                                // [EN] Restore the terminal and print bytes/frame
+        const char off[]="\x1b[0m\x1b[?25h\x1b[?1049l";
+        writeAll(1,off,sizeof off-1);
+        tcsetattr(0,TCSANOW,&saved);
+        std::fprintf(stderr,"frames: %llu, output: %.0f bytes/frame\n",(unsigned long long)enc.frames,enc.bytesPerFrame());
+    }
+    Geom geom() override {                      // [RU] ioctl только после SIGWINCH, а не каждый кадр
+                                                // [EN] ioctl only after SIGWINCH, not every frame
+        if(termResized){ termResized=0; winsize ws{};
+            if(ioctl(1,TIOCGWINSZ,&ws)==0&&ws.ws_col>0&&ws.ws_row>0){
+                float aspect = ws.ws_xpixel&&ws.ws_ypixel ? ((float)ws.ws_ypixel/ws.ws_row)/((float)ws.ws_xpixel/ws.ws_col) : 2.0f; // [RU] Пиксели известны не всегда
+                                                                                                                                     // [EN] Pixel sizes are not always known
+                g={ws.ws_col,ws.ws_row,aspect}; }
+            enc.invalidate(); }                 // [RU] После ресайза экран перерисовываем целиком
+                                                // [EN] After a resize the screen is redrawn in full
+        return g;
+    }
+    void present(const Frame&fr) override {
+        buf.clear(); enc.encode(fr,buf);        // [RU] Курсор + SGR + символы — одним буфером
+                                                // [EN] Cursor + SGR + glyphs — in one buffer
+        writeAll(1,buf.data(),buf.size());
+    }
+};
+
+// [RU] --- Клавиши из stdin: + (или =) - [ ] и одиночный ESC / Ctrl-C ---
+// [EN] --- Keys from stdin: + (or =) - [ ] and a lone ESC / Ctrl-C ---
+struct KeyReader{
+    int poll(Key*out,int max){
+        unsigned char b[64]; ssize_t r=::read(0,b,sizeof b); int n=0;
+        for(ssize_t i=0;i<r&&n<max;++i){
+            switch(b[i]){
+            case '+': case '=': out[n++]=Key::Plus; break;
+            case '-': out[n++]=Key::Minus; break;
+            case '[': out[n++]=Key::Slower; break;
+            case ']': out[n++]=Key::Faster; break;
+            case 3: out[n++]=Key::Quit; break;
+            case 0x1b:                          // [RU] ESC[… / ESCO… — стрелки и прочие последовательности, пропускаем
+                                                // [EN] ESC[… / ESCO… — arrows and other sequences, skipped
+                if(i+1<r&&(b[i+1]=='['||b[i+1]=='O')){ i+=2; while(i<r&&(b[i]<0x40||b[i]>0x7E)) ++i; }
+                else out[n++]=Key::Quit;
+                break;
+            }
+        }
+        return n;
+    }
+    int wait(Key*out,int max,int timeoutMs){    // [RU] Для потока ввода: блокируемся в poll() до байта или таймаута
+                                                // [EN] For the input thread: block in poll() until a byte or the timeout
+        pollfd p{0,POLLIN,0};
+        if(::poll(&p,1,timeoutMs)<=0) return 0;
+        return poll(out,max);
+    }
+};
+
+#endif
+
+// [RU] Кадр записи в окне текущего размера: по центру, что не влезает — обрезается; true — если обрезали
+// [EN] A recorded frame in a window of the current size: centered, whatever does not fit is cropped; true if cropped
+static bool fitToWindow(const Frame&src,Frame&dst,const Geom&g){
+    if(dst.W!=g.W||dst.H!=g.H) dst.resize(g.W,g.H); else dst.clear();
+    const int ox=(g.W-src.W)/2, oy=(g.H-src.H)/2; // [RU] Отрицательный сдвиг — кадр больше окна
+                                                  // [EN] A negative offset — the frame is larger than the window
+    const int x0=std::max(0,-ox), x1=std::min(src.W,g.W-ox), y0=std::max(0,-oy), y1=std::min(src.H,g.H-oy);
+    for(int y=y0;y<y1;++y) for(int x=x0;x<x1;++x) dst.set((size_t)(y+oy)*(size_t)g.W+(size_t)(x+ox),src.at((size_t)y*(size_t)src.W+(size_t)x));
+    return src.W>g.W||src.H>g.H;
 }
 
-// [RU] --- Главная программа: фронт-face-culling + ambient + цвета + улучшенная окклюзия ---
-// [EN] --- Main program: front-face culling + ambient + colors + improved occlusion ---
-int main(){                                     // [RU] Начало пути — всё просто
+// [RU] --- Воспроизведение записи: в исходном темпе или так быстро, как примет терминал ---
+// [EN] --- Replaying a recording: at the original pace or as fast as the terminal accepts ---
+static int replay(const char*path,bool fast){
+    ReplayReader rd; std::string err;
+    if(!rd.open(path,err)){ std::fprintf(stderr,"cube: %s\n",err.c_str()); return 1; }
+    int r=0; bool cropped=false; int recW=0,recH=0,winW=0,winH=0; // [RU] Сообщение об обрезке — после восстановления терминала
+                                                                 // [EN] The crop message — once the terminal is restored
+    {                                           // [RU] Область жизни консоли/терминала
+                                                // [EN] Lifetime scope of the console/terminal
+#ifdef _WIN32
+    ConsoleCursorGuard _cur;
+    TimerResolutionGuard _timer;                // [RU] Паузы по записи — с точностью 1 мс
+                                                // [EN] Pauses from the recording — with 1 ms precision
+    ConsoleTarget target(GetStdHandle(STD_OUTPUT_HANDLE));
+#else
+    TermTarget target;
+#endif
+    KeyReader keys; InputThread<Key,KeyReader> input(keys); // [RU] Только ESC — выход
+                                                            // [EN] ESC only — exit
+    Frame frame, view; const auto t0=SchedClock::now(); bool quit=false;
+    while(!quit&&(r=rd.next(err))==1){
+        InputThread<Key,KeyReader>::Event ev; while(input.pop(ev)) if(ev.key==Key::Quit) quit=true;
+        if(!fast) std::this_thread::sleep_until(t0+std::chrono::nanoseconds(rd.t)); // [RU] Время кадра из записи
+                                                                                     // [EN] Frame time from the recording
+        const Geom g=target.geom();             // [RU] Как в main: на Windows geom() ещё и снимает winL/winT для blit
+                                                // [EN] As in main: on Windows geom() also captures winL/winT for the blit
+        rd.toFrame(frame);
+        if(fitToWindow(frame,view,g)&&!cropped){ cropped=true; recW=frame.W; recH=frame.H; winW=g.W; winH=g.H; }
+        target.present(view);
+    }
+    if(quit) r=0;
+    }
+    if(cropped) std::fprintf(stderr,"cube: %s is %dx%d, the window was %dx%d — frames were cropped\n",path,recW,recH,winW,winH);
+    if(r<0){ std::fprintf(stderr,"cube: %s: %s\n",path,err.c_str()); return 1; }
+    return 0;
+}
+
+// [RU] --- Главная программа: ввод, тайминг и вывод; сам рендер — в pipeline.h ---
+// [EN] --- Main program: input, timing and output; the rendering itself lives in pipeline.h ---
+int main(int argc,char**argv){                  // [RU] Начало пути — всё просто
                                                 // [EN] Starting point — nice and simple
+    RenderParams rp;                            // [RU] Палитра, свет, камера, шаг сетки, масштаб куба, растеризатор
+                                                // [EN] Ramp, light, camera, grid step, cube scale, rasterizer
+    Renderer renderer;                          // [RU] Состояние рендера между кадрами
+                                                // [EN] Renderer state across frames
+    int threads=(int)std::max(1u,std::thread::hardware_concurrency()); // [RU] Все ядра для тайлового режима
+                                                                       // [EN] All cores for the tiled mode
+    double fps=60.0;                            // [RU] Целевой FPS; 0 — без ограничения
+                                                // [EN] Target FPS; 0 — uncapped
+    std::vector<const char*> models; int instances=0; // [RU] --model/--instances включают сцену мешей вместо куба
+                                                      // [EN] --model/--instances switch to a mesh scene instead of the cube
+    const char*recordPath=nullptr,*replayPath=nullptr,*castPath=nullptr; bool fast=false; // [RU] Запись/воспроизведение
+                                                                                           // [EN] Recording/replay
+    const char*tracePath="cube.trace.json";     // [RU] Куда писать trace_event JSON (сборка с -DCUBE_TRACE)
+                                                // [EN] Where the trace_event JSON goes (build with -DCUBE_TRACE)
+    for(int i=1;i<argc;++i){                    // [RU] --raster …|sampler — старый сэмплер для сравнения
+                                                // [EN] --raster …|sampler — the old sampler for comparison
+        if(!std::strcmp(argv[i],"--raster")&&i+1<argc&&parseRasterMode(argv[i+1],rp.mode)){ ++i; continue; }
+        if(!std::strcmp(argv[i],"--isa")&&i+1<argc&&parseIsa(argv[i+1],renderer.batch.isa)){ ++i; continue; }
+        if(!std::strcmp(argv[i],"--threads")&&i+1<argc&&std::atoi(argv[i+1])>0){ threads=std::atoi(argv[++i]); continue; }
+        if(!std::strcmp(argv[i],"--fps")&&i+1<argc&&std::atof(argv[i+1])>=0){ fps=std::atof(argv[++i]); continue; }
+        if(!std::strcmp(argv[i],"--model")&&i+1<argc){ models.push_back(argv[++i]); continue; }
+        if(!std::strcmp(argv[i],"--instances")&&i+1<argc&&std::atoi(argv[i+1])>0){ instances=std::atoi(argv[++i]); continue; }
+        if(!std::strcmp(argv[i],"--record")&&i+1<argc){ recordPath=argv[++i]; continue; }
+        if(!std::strcmp(argv[i],"--replay")&&i+1<argc){ replayPath=argv[++i]; continue; }
+        if(!std::strcmp(argv[i],"--cast")&&i+1<argc){ castPath=argv[++i]; continue; }
+        if(!std::strcmp(argv[i],"--fast")){ fast=true; continue; }
+        if(!std::strcmp(argv[i],"--trace")&&i+1<argc){ tracePath=argv[++i];
+            if(!traceEnabled()){ std::fprintf(stderr,"cube: --trace needs a build with -DCUBE_TRACE\n"); return 2; } continue; }
+        std::fprintf(stderr,"usage: cube [--raster tiled|scanline|batch|sampler] [--isa auto|scalar|sse2|avx2] [--threads N] [--fps N|0]\n"
+                            "            [--model FILE.stl|FILE.obj]... [--instances N] [--record FILE] [--trace FILE]\n"
+                            "       cube --replay FILE [--fast] [--cast OUT.cast]\n"); return 2;
+    }
+    if(replayPath&&castPath){ std::string err;  // [RU] Экспорт без терминала
+                                                // [EN] Export without a terminal
+        if(!exportAsciicast(replayPath,castPath,err)){ std::fprintf(stderr,"cube: %s\n",err.c_str()); return 1; }
+        return 0; }
+    if(replayPath) return replay(replayPath,fast);
+    renderer.tiled.setThreads(threads);
+
+    std::vector<Mesh> meshes(models.empty()?1:models.size()); // [RU] Меши грузятся до захвата терминала — ошибки видны
+                                                              // [EN] Meshes load before the terminal is taken over — errors stay visible
+    for(size_t i=0;i<models.size();++i){ std::string err;
+        if(!loadMesh(models[i],meshes[i],err)){ std::fprintf(stderr,"cube: %s\n",err.c_str()); return 1; }
+        meshes[i].fitUnit(); }
+    if(models.empty()) meshes[0]=cubeMesh();   // [RU] Без файлов — куб как меш (например, --instances 16)
+                                               // [EN] Without files — the cube as a mesh (e.g. --instances 16)
+    const bool useScene=!models.empty()||instances>0;
+    Scene scene; { std::vector<const Mesh*> ms; for(const Mesh&m:meshes) ms.push_back(&m);
+        scene.grid(ms,std::max(instances,(int)ms.size())); } // [RU] Не меньше экземпляра на модель: --model повторяемый
+                                                             // [EN] At least one instance per model: --model repeats
+    FrameScheduler sched(fps);                  // [RU] Абсолютные дедлайны + гистограммы; печатаются после восстановления консоли
+                                                // [EN] Absolute deadlines + histograms; printed once the console is restored
+    Recorder rec;                               // [RU] Фоновый писатель; открывается до захвата терминала — ошибки видны
+                                                // [EN] Background writer; opened before the terminal is taken over — errors stay visible
+    if(recordPath&&!rec.open(recordPath)){ std::fprintf(stderr,"cube: cannot create %s\n",recordPath); return 1; }
+
+    {                                           // [RU] Область жизни консоли/терминала
+                                                // [EN] Lifetime scope of the console/terminal
+#ifdef _WIN32
     ConsoleCursorGuard _cur;                    // [RU] Скрываем курсор на время демо
                                                 // [EN] Hide cursor for the demo
-    HANDLE h=GetStdHandle(STD_OUTPUT_HANDLE);   // [RU] Дескриптор консоли
-                                                // [EN] Console handle
-
-    const std::string ramp = " .,:;ox%#@";      // [RU] Мягкая палитра без «полосатых» символов
-                                                // [EN] Soft palette without "stripy" characters
-    const Vec3 lightDir = norm({-0.5f,1.0f,1.2f}); // [RU] Свет от верх-лево-вперёд — красивый рельеф
-                                                   // [EN] Light from up-left-forward — pleasing relief
-    const float ambient = 0.25f;                // [RU] Базовая подсветка чуть ярче для контраста
-                                                // [EN] Base ambient slightly brighter for contrast
-    const float camZ    = 3.2f;                 // [RU] Двигаем сцену вперёд — камера в (0,0,0), смотрит вдоль +Z
-                                                // [EN] Push the scene forward — camera at (0,0,0), looking along +Z
-    const float nearZ   = 0.25f;                // [RU] Ближняя плоскость — не даём проходить через камеру
-                                                // [EN] Near plane — prevent passing through the camera
-    const float step    = 0.032f;               // [RU] Шаг параметрической сетки по граням — плотность/скорость
-                                                // [EN] Parametric grid step on faces — density/speed
+    TimerResolutionGuard _timer;                // [RU] Дедлайны кадров и опрос клавиш — с точностью 1 мс
+                                                // [EN] Frame deadlines and key polling — with 1 ms precision
+    ConsoleTarget target(GetStdHandle(STD_OUTPUT_HANDLE)); // [RU] Куда рисуем
+                                                           // [EN] Where we draw
+#else
+    TermTarget target;                          // [RU] Raw-режим и альтернативный экран на время демо
+                                                // [EN] Raw mode and alternate screen for the demo
+#endif
+    KeyReader keys;                             // [RU] Источник нажатий
+                                                // [EN] Key press source
+    InputThread<Key,KeyReader> input(keys);     // [RU] Отдельный поток ввода → lock-free очередь
+                                                // [EN] Dedicated input thread → lock-free queue
 
-    float cubeScale = 1.0f;                     // [RU] Масштаб куба (изменяется на + и -)
-                                                // [EN] Cube scale (adjust with + and -)
     float rotSpeed = 1.0f;                      // [RU] Множитель скорости вращения (изменяется на [ и ])
                                                 // [EN] Rotation speed multiplier (adjust with [ and ])
 
-    // [RU] Цвета для каждой грани (атрибуты: текст + интенсивность)
-    // [EN] Colors for each face (attributes: text + intensity)
-    const WORD faceColors[6] = {
-        FOREGROUND_RED | FOREGROUND_INTENSITY,     // [RU] X+ красный
-                                                   // [EN] X+ red
-        FOREGROUND_GREEN | FOREGROUND_INTENSITY,   // [RU] X- зелёный
-                                                   // [EN] X- green
-        FOREGROUND_BLUE | FOREGROUND_INTENSITY,    // [RU] Y+ синий
-                                                   // [EN] Y+ blue
-        FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_INTENSITY, // [RU] Y- жёлтый
-                                                                  // [EN] Y- yellow
-        FOREGROUND_RED | FOREGROUND_BLUE | FOREGROUND_INTENSITY,  // [RU] Z+ magenta
-                                                                  // [EN] Z+ magenta
-        FOREGROUND_GREEN | FOREGROUND_BLUE | FOREGROUND_INTENSITY // [RU] Z- cyan
-                                                                  // [EN] Z- cyan
-    };
-
-    // [RU] Состояния клавиш для обнаружения "нажатия" (не удержания)
-    // [EN] Key states to detect a "press" (not a hold)
-    bool prevPlus = false, prevMinus = false, prevLB = false, prevRB = false, prevEsc = false;
-
-    ConsoleGeom g = queryConsoleGeom(h);        // [RU] Снимаем геометрию и форму символа
+    Geom g = target.geom();                     // [RU] Снимаем геометрию и форму символа
                                                 // [EN] Query geometry and character shape
     Projector proj(g);                          // [RU] Готовим проектор под текущий шрифт
                                                 // [EN] Prepare projector for current font
+    Frame frame; frame.resize(g.W,g.H);         // [RU] Глубина + символ + цвет в одной ячейке, память из арены
+                                                // [EN] Depth + character + color in one cell, memory from the arena
 
-    std::vector<float> zbuf((size_t)g.winW*(size_t)g.winH); // [RU] z-буфер (обратная глубина)
-                                                            // [EN] z-buffer (inverse depth)
-    std::vector<CHAR_INFO> cbuf((size_t)g.winW*(size_t)g.winH); // [RU] Буфер символов и цветов (фон чёрный по умолчанию)
-                                                                // [EN] Character/color buffer (black background by default)
-
-    auto t0=std::chrono::steady_clock::now();   // [RU] Нулевая отметка времени
+    const auto t0=sched.deadline;               // [RU] Нулевая отметка времени
                                                 // [EN] Time zero
+    auto frameTime=t0;                          // [RU] Дедлайн текущего кадра — по нему считается анимация
+                                                // [EN] Current frame deadline — animation is computed from it
+    traceFrameReserve();                        // [RU] Регистрация потока в trace и ряд кадров — до цикла
+                                                // [EN] Trace registration and the frame series — before the loop
 
     for(;;){                                     // [RU] Основной цикл анимации
                                                  // [EN] Main animation loop
-        // [RU] --- Обработка клавиш (только на нажатие, не на удержание) ---
-        // [EN] --- Key handling (on press only, not on hold) ---
-        bool currPlus = GetAsyncKeyState(VK_OEM_PLUS) & 0x8000;    // [RU] + (масштаб вверх)
-                                                                   // [EN] + (scale up)
-        bool currMinus = GetAsyncKeyState(VK_OEM_MINUS) & 0x8000;  // [RU] - (масштаб вниз)
-                                                                   // [EN] - (scale down)
-        bool currLB = GetAsyncKeyState(VK_OEM_4) & 0x8000;         // [RU] [ (скорость вниз)
-                                                                   // [EN] [ (speed down)
-        bool currRB = GetAsyncKeyState(VK_OEM_6) & 0x8000;         // [RU] ] (скорость вверх)
-                                                                   // [EN] ] (speed up)
-        bool currEsc = GetAsyncKeyState(VK_ESCAPE) & 0x8000;       // [RU] ESC (выход)
-                                                                   // [EN] ESC (exit)
-
-        if (currPlus && !prevPlus) cubeScale = std::max(0.1f, cubeScale + 0.1f);
-        if (currMinus && !prevMinus) cubeScale = std::max(0.1f, cubeScale - 0.1f);
-        if (currLB && !prevLB) rotSpeed = std::max(0.0f, rotSpeed - 0.1f);
-        if (currRB && !prevRB) rotSpeed += 0.1f;
-        if (currEsc && !prevEsc) break;  // [RU] Выход из цикла на ESC
+        const auto frameStart=SchedClock::now(); // [RU] Фактическое начало работы над кадром
+                                                 // [EN] When work on the frame actually began
+        // [RU] --- Клавиши из очереди потока ввода: всё, что пришло к началу кадра ---
+        // [EN] --- Keys from the input thread queue: everything that arrived by frame start ---
+        SchedClock::time_point keyTimes[16]; int nkeys=0; bool quit=false;
+        InputThread<Key,KeyReader>::Event ev;
+        {                                        // [RU] Стадия «ввод» в трассе
+                                                 // [EN] The "input" stage in the trace
+            TRACE_SCOPE(TS_INPUT,-1);
+            while(input.pop(ev)){
+                switch(ev.key){
+                case Key::Plus:   rp.cubeScale = std::max(0.1f, rp.cubeScale + 0.1f); break; // [RU] + (масштаб вверх)
+                                                                                             // [EN] + (scale up)
+                case Key::Minus:  rp.cubeScale = std::max(0.1f, rp.cubeScale - 0.1f); break; // [RU] - (масштаб вниз)
+                                                                                             // [EN] - (scale down)
+                case Key::Slower: rotSpeed = std::max(0.0f, rotSpeed - 0.1f); break;         // [RU] [ (скорость вниз)
+                                                                                             // [EN] [ (speed down)
+                case Key::Faster: rotSpeed += 0.1f; break;                                   // [RU] ] (скорость вверх)
+                                                                                             // [EN] ] (speed up)
+                case Key::Quit:   quit=true; break;                                          // [RU] ESC (выход)
+                                                                                             // [EN] ESC (exit)
+                }
+                if(nkeys<16) keyTimes[nkeys++]=ev.t; // [RU] Для input-to-photon
+                                                     // [EN] For input-to-photon
+            }
+        }
+        if(quit) break;                  // [RU] Выход из цикла на ESC
                                          // [EN] Exit the loop on ESC
 
-        prevPlus = currPlus; prevMinus = currMinus; prevLB = currLB; prevRB = currRB; prevEsc = currEsc;
-
         // [RU] --- Продолжение рендеринга ---
         // [EN] --- Rendering continues ---
-        ConsoleGeom ng=queryConsoleGeom(h);      // [RU] Адаптация к динамическому ресайзу/смене шрифта
-                                                 // [EN] Adapt to dynamic resize/font change
-        if(ng.winW<40||ng.winH<20){ std::this_thread::sleep_for(std::chrono::milliseconds(50)); continue; } // [RU] Ждём адекватный размер
-                                                                                                            // [EN] Wait for a reasonable size
-        if(ng.winW!=g.winW||ng.winH!=g.winH||std::abs(ng.charAspect-g.charAspect)>1e-3f){ // [RU] Изменение метрики
-                                                                                          // [EN] Metrics changed
-            g=ng; proj=Projector(g); zbuf.assign((size_t)g.winW*(size_t)g.winH,-1e9f);
-            cbuf.assign((size_t)g.winW*(size_t)g.winH, { ' ', 0 }); // [RU] Очистка с чёрным фоном
-                                                                    // [EN] Clear with black background
-        }else{ std::fill(zbuf.begin(),zbuf.end(),-1e9f);
-            std::fill(cbuf.begin(),cbuf.end(), CHAR_INFO{ ' ', 0 }); } // [RU] Обычная очистка
-                                                                       // [EN] Regular clear
-
-        float t=std::chrono::duration<float>(std::chrono::steady_clock::now()-t0).count(); // [RU] Секунды с запуска
-                                                                                           // [EN] Seconds since start
-        float ax=t*0.9f*rotSpeed, ay=t*0.7f*rotSpeed+1.3f, az=t*1.1f*rotSpeed+0.7f; // [RU] Независимые фазы — приятная динамика
-                                                                                    // [EN] Independent phases — pleasant dynamics
-        float sx=std::sin(ax),cx=std::cos(ax), sy=std::sin(ay),cy=std::cos(ay), sz=std::sin(az),cz=std::cos(az); // [RU] Предрасчёт тригонометрии
-                                                                                                                 // [EN] Precompute trigonometry
-
-        for(int faceIndex=0; faceIndex<6; ++faceIndex){ // [RU] По всем шести граням с индексом
-                                                        // [EN] Iterate over all six faces by index
-            const Face& f = cubeFaces[faceIndex];
-            Vec3 nCam = rotateAll(mul(norm(f.axis),f.sign), sx,cx,sy,cy,sz,cz); // [RU] Нормаль грани в координатах камеры
-                                                                                // [EN] Face normal in camera coordinates
-            if(nCam.z >= 0.0f) continue;         // [RU] BACK-FACE CULLING: грань от камеры — не рисуем её вовсе
-                                                 // [EN] BACK-FACE CULLING: face turned away from the camera — skip drawing entirely
-            float lambert = std::max(0.0f, dot(nCam, lightDir)); // [RU] Диффузная составляющая света
-                                                                 // [EN] Diffuse light component
-            float shadeF  = std::clamp(ambient + (1.0f-ambient)*lambert, 0.0f, 1.0f); // [RU] Ambient + diffuse
-                                                                                      // [EN] Ambient + diffuse
-            shadeF *= (0.8f + 0.4f * (faceIndex % 2)); // [RU] Per-face контраст: чередование яркости
-                                                       // [EN] Per-face contrast: alternating brightness
-
-            // [RU] Полуоткрытые интервалы для избежания дубликатов на ребрах
-            // [EN] Half-open intervals to avoid duplicates on edges
-            for(float u=-1.0f; u < 1.0f + step/2; u+=step){          
-                for(float v=-1.0f; v < 1.0f + step/2; v+=step){      
-                    Vec3 rawP = mul(pointOnFace(f,u,v), cubeScale); // [RU] Масштабируем точку грани
-                                                                    // [EN] Scale the face point
-                    Vec3 p = rotateAll(rawP, sx,cx,sy,cy,sz,cz);   // [RU] Поворачиваем
-                                                                   // [EN] Rotate it
-                    p = add(p,{0,0,camZ});                         // [RU] Отодвигаем сцену от камеры
-                                                                   // [EN] Move the scene away from the camera
-                    if(p.z<=nearZ) continue;                       // [RU] Отсекаем «слишком близко» — без артефактов у стекла
-                                                                   // [EN] Clip "too close" — avoids artifacts at the near plane
-
-                    int sxp,syp; if(!proj.toScreen(p,sxp,syp)) continue; // [RU] Проекция и отсечение по экрану
-                                                                         // [EN] Projection and screen clipping
-
-                    float invz = 1.0f/p.z + 1e-5f * (float)faceIndex; // [RU] Обратная глубина + bias для стабильности на ребрах
-                                                                      // [EN] Inverse depth + bias for stability along edges
-                    size_t idx=(size_t)syp*(size_t)g.winW+(size_t)sxp; // [RU] Индекс пикселя в нашем видимом окне
-                                                                       // [EN] Pixel index within our visible window
-                    if(invz>zbuf[idx]){                       // [RU] Z-тест — пишем только ближнее
-                                                              // [EN] Z-test — write only the nearer
-                        zbuf[idx]=invz;                       // [RU] Обновляем глубину
-                                                              // [EN] Update depth
-                        int shade=(int)std::round(shadeF*(int)(ramp.size()-1)); // [RU] Индекс символа по яркости
-                                                                                // [EN] Character index by brightness
-                        shade=std::clamp(shade,0,(int)ramp.size()-1); // [RU] Защита от округления
-                                                                      // [EN] Guard against rounding
-                        cbuf[idx].Char.AsciiChar = ramp[(size_t)shade]; // [RU] Символ
-                                                                        // [EN] Character
-                        cbuf[idx].Attributes = faceColors[faceIndex];   // [RU] Цвет грани
-                                                                        // [EN] Face color
-                    }
-                }
-            }
+        if(rec.isOpen()) rec.reclaim();                       // [RU] Кадр снова наш: снимок готов или кадр пропущен, диск не ждём
+                                                              // [EN] The frame is ours again: the snapshot is done or the frame is skipped, no disk wait
+        Geom ng; { TRACE_SCOPE(TS_GEOM,-1); ng=target.geom(); } // [RU] Адаптация к динамическому ресайзу/смене шрифта
+                                                                // [EN] Adapt to dynamic resize/font change
+        if(ng.W<40||ng.H<20){ std::this_thread::sleep_for(std::chrono::milliseconds(50)); frameTime=sched.waitNext(); continue; } // [RU] Ждём адекватный размер
+                                                                                                                                 // [EN] Wait for a reasonable size
+        if(ng.W!=g.W||ng.H!=g.H||std::abs(ng.charAspect-g.charAspect)>1e-3f){ // [RU] Изменение метрики
+                                                                              // [EN] Metrics changed
+            g=ng; proj=Projector(g); frame.resize(g.W,g.H);
         }
 
-        blitFrame(h,g,cbuf);                                  // [RU] Выводим кадр напрямую в консоль с цветами
-                                                              // [EN] Output the frame directly to the console with colors
-        std::this_thread::sleep_for(std::chrono::milliseconds(16)); // [RU] ~60 FPS
-                                                                    // [EN] ~60 FPS
+        float t=std::chrono::duration<float>(frameTime-t0).count(); // [RU] Секунды с запуска по сетке дедлайнов — без дрожи
+                                                                    // [EN] Seconds since start on the deadline grid — jitter-free
+        if(useScene) renderer.render(frame,proj,rp,scene,t,rotSpeed); // [RU] Все экземпляры: треугольники + z-тест
+                                                                      // [EN] Every instance: triangles + z-test
+        else renderer.render(frame,proj,rp,Pose::at(t,rotSpeed));     // [RU] Очистка + шесть граней + z-тест
+                                                                      // [EN] Clear + six faces + z-test
+
+        { TRACE_SCOPE(TS_BLIT,-1); target.present(frame); }  // [RU] Выводим кадр в консоль/терминал с цветами
+                                                              // [EN] Output the frame to the console/terminal with colors
+        const auto shown=SchedClock::now();
+        sched.framePresented(frameStart,shown);
+        TRACE_FRAME();                                        // [RU] Счётчики кадра — в сводку и на график
+                                                              // [EN] The frame's counters — into the summary and the chart
+        for(int i=0;i<nkeys;++i) sched.inputShown(keyTimes[i],shown);
+        if(rec.isOpen()) rec.submit(frame,(uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(shown-t0).count()); // [RU] Публикация кадра: снимок снимет писатель, пока мы спим
+                                                                                                                           // [EN] Publish the frame: the writer snapshots it while we sleep
+        frameTime=sched.waitNext();                           // [RU] Сон до абсолютного дедлайна с учётом времени рендера
+                                                              // [EN] Sleep until the absolute deadline, net of render time
+    }
+    if(rec.isOpen()) rec.flush();                             // [RU] Последний кадр — в снимок, пока он ещё жив
+                                                              // [EN] The last frame into the snapshot while it is still alive
     }
 
+    sched.print(stderr);                                      // [RU] Гистограммы времени кадра, опоздания сна и задержки ввода
+                                                              // [EN] Histograms of frame time, sleep overshoot and input latency
+    if(rec.isOpen()){ rec.close(); rec.print(stderr); }        // [RU] Дописать последний снимок и показать итог
+                                                              // [EN] Write the last snapshot and show the totals
+    if(traceEnabled()){                                       // [RU] Сводка по стадиям/счётчикам и JSON для chrome://tracing
+                                                              // [EN] Stage/counter summary and JSON for chrome://tracing
+        tracePrint(stderr);
+        if(traceWrite(tracePath)) std::fprintf(stderr,"trace: wrote %s\n",tracePath);
+        else std::fprintf(stderr,"cube: cannot write %s\n",tracePath);
+    }
     return 0;                                                 // [RU] Теперь достижимо на ESC
                                                               // [EN] Now reachable via ESC
 }
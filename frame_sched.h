@@ -0,0 +1,146 @@
+// [RU] === frame_sched.h — планировщик кадров по абсолютным дедлайнам, поток ввода и гистограммы задержек ===
+// [EN] === frame_sched.h — absolute-deadline frame scheduler, input thread and latency histograms ===
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+
+typedef std::chrono::steady_clock SchedClock;  // [RU] Монотонные часы для всех меток
+                                               // [EN] Monotonic clock for every timestamp
+
+// [RU] --- Лог-линейная гистограмма в наносекундах: 16 корзин на октаву, точность ~6%, без аллокаций ---
+// [EN] --- Log-linear histogram in nanoseconds: 16 buckets per octave, ~6% precision, no allocations ---
+struct Histogram{
+    enum{ SUB=16, BUCKETS=64*SUB };
+    uint64_t counts[BUCKETS]{}; uint64_t n=0, minV=UINT64_MAX, maxV=0; double sum=0;
+    static int bucketOf(uint64_t v){
+        if(v<SUB) return (int)v;
+        int msb=63-__builtin_clzll(v), shift=msb-4; // [RU] Старшие 5 бит: 1 + 4 бита подкорзины
+                                                    // [EN] Top 5 bits: the leading 1 + 4 sub-bucket bits
+        return (shift+1)*SUB+(int)((v>>shift)&(SUB-1));
+    }
+    static uint64_t lowerOf(int b){ if(b<SUB) return (uint64_t)b; int shift=b/SUB-1; return (uint64_t)(SUB+b%SUB)<<shift; }
+    void record(int64_t ns){ uint64_t v=ns>0?(uint64_t)ns:0; ++counts[bucketOf(v)]; ++n; sum+=(double)v; minV=std::min(minV,v); maxV=std::max(maxV,v); }
+    uint64_t percentile(double p)const{        // [RU] Нижняя граница корзины с рангом ceil(p·n)
+                                               // [EN] Lower bound of the bucket holding rank ceil(p·n)
+        if(!n) return 0;
+        uint64_t rank=std::max<uint64_t>(1,(uint64_t)(p*(double)n+0.999999)), acc=0;
+        for(int b=0;b<BUCKETS;++b){ acc+=counts[b]; if(acc>=rank) return std::clamp(lowerOf(b),minV,maxV); }
+        return maxV;
+    }
+    void print(FILE*f,const char*name)const{   // [RU] Одна строка таблицы, микросекунды
+                                               // [EN] One table row, microseconds
+        if(!n){ std::fprintf(f,"%-10s %8d\n",name,0); return; }
+        std::fprintf(f,"%-10s %8llu %9.1f %9.1f %9.1f %9.1f %9.1f %9.1f %9.1f\n",name,(unsigned long long)n,sum/(double)n/1e3,
+            minV/1e3,percentile(0.50)/1e3,percentile(0.90)/1e3,percentile(0.99)/1e3,percentile(0.999)/1e3,maxV/1e3);
+    }
+    static void printHeader(FILE*f){ std::fprintf(f,"%-10s %8s %9s %9s %9s %9s %9s %9s %9s   (us)\n","","count","mean","min","p50","p90","p99","p99.9","max"); }
+};
+
+// [RU] --- Однопроизводительная/однопотребительская очередь без блокировок (кольцо, N — степень двойки) ---
+// [EN] --- Lock-free single-producer/single-consumer queue (a ring, N is a power of two) ---
+template<class T,size_t N> struct SpscQueue{
+    static_assert((N&(N-1))==0,"N must be a power of two");
+    T buf[N];
+    alignas(64) std::atomic<size_t> head{0};   // [RU] Пишет только потребитель
+                                               // [EN] Written only by the consumer
+    alignas(64) std::atomic<size_t> tail{0};   // [RU] Пишет только производитель
+                                               // [EN] Written only by the producer
+    bool push(const T&v){                      // [RU] false — очередь полна, событие теряется
+                                               // [EN] false — the queue is full, the event is lost
+        size_t t=tail.load(std::memory_order_relaxed);
+        if(t-head.load(std::memory_order_acquire)==N) return false;
+        buf[t&(N-1)]=v; tail.store(t+1,std::memory_order_release); return true;
+    }
+    bool pop(T&v){
+        size_t h=head.load(std::memory_order_relaxed);
+        if(h==tail.load(std::memory_order_acquire)) return false;
+        v=buf[h&(N-1)]; head.store(h+1,std::memory_order_release); return true;
+    }
+};
+
+// [RU] --- Поток ввода: ждёт клавиши у Reader и кладёт их с меткой времени в очередь; кадр забирает их в начале ---
+// [EN] --- Input thread: waits on the Reader for keys and queues them timestamped; a frame drains them at its start ---
+// [RU] Reader::wait(Key*out,int max,int timeoutMs) — число событий, 0 по таймауту.
+// [EN] Reader::wait(Key*out,int max,int timeoutMs) — event count, 0 on timeout.
+template<class Key,class Reader> struct InputThread{
+    struct Event{ Key key; SchedClock::time_point t; }; // [RU] t — когда клавишу прочитали: начало input-to-photon
+                                                        // [EN] t — when the key was read: the start of input-to-photon
+    SpscQueue<Event,256> q;
+    std::atomic<bool> stop{false};
+    Reader&reader; std::thread th;
+    explicit InputThread(Reader&r):reader(r),th([this]{ loop(); }){}
+    ~InputThread(){ stop.store(true); th.join(); } // [RU] Таймаут wait ограничивает задержку выхода
+                                                   // [EN] The wait timeout bounds the shutdown delay
+    bool pop(Event&e){ return q.pop(e); }
+private:
+    void loop(){
+        Key ks[16];
+        while(!stop.load(std::memory_order_relaxed)){
+            int n=reader.wait(ks,16,10);
+            auto now=SchedClock::now();
+            for(int i=0;i<n;++i) q.push(Event{ks[i],now});
+        }
+    }
+};
+
+// [RU] --- Планировщик: дедлайн кадра k = старт + k·период; опоздал — пропускаем целые периоды, а не копим сдвиг ---
+// [EN] --- Scheduler: frame k's deadline = start + k·period; when late, skip whole periods instead of drifting ---
+struct FrameScheduler{
+    SchedClock::duration period{0};            // [RU] 0 — без ограничения FPS
+                                               // [EN] 0 — uncapped FPS
+    SchedClock::time_point deadline{};         // [RU] Момент, на который рассчитан текущий кадр
+                                               // [EN] The instant the current frame is scheduled for
+    uint64_t frames=0, dropped=0;              // [RU] Показано / пропущено периодов
+                                               // [EN] Presented / skipped periods
+    Histogram render, overshoot, latency;      // [RU] Время рендера+вывода, опоздание пробуждения, input-to-photon
+                                               // [EN] Render+present time, wake-up overshoot, input-to-photon
+
+#ifdef _WIN32                                  // [RU] Сколько до дедлайна досыпается через yield
+                                               // [EN] How much before the deadline is spent yielding
+    static constexpr std::chrono::milliseconds sleepMargin{2};
+#else
+    static constexpr std::chrono::milliseconds sleepMargin{1};
+#endif
+
+    explicit FrameScheduler(double fps){
+        if(fps>0) period=std::chrono::duration_cast<SchedClock::duration>(std::chrono::duration<double>(1.0/fps));
+        deadline=SchedClock::now();
+    }
+    void framePresented(SchedClock::time_point start,SchedClock::time_point presented){ // [RU] Учёт кадра
+                                                                                         // [EN] Account for a frame
+        ++frames; render.record(std::chrono::duration_cast<std::chrono::nanoseconds>(presented-start).count());
+    }
+    void inputShown(SchedClock::time_point keyTime,SchedClock::time_point presented){
+        latency.record(std::chrono::duration_cast<std::chrono::nanoseconds>(presented-keyTime).count());
+    }
+    SchedClock::time_point waitNext(){         // [RU] Спим до следующего дедлайна и возвращаем его
+                                               // [EN] Sleep until the next deadline and return it
+        auto now=SchedClock::now();
+        if(period.count()==0){ deadline=now; return deadline; } // [RU] Без ограничения — сразу дальше
+                                                                // [EN] Uncapped — go straight on
+        deadline+=period;
+        if(now>deadline){                      // [RU] Опоздали: пропускаем пропущенные слоты целиком
+                                               // [EN] Late: skip the missed slots entirely
+            auto missed=(now-deadline)/period+1; dropped+=(uint64_t)missed; deadline+=missed*period;
+        }
+        // [RU] sleep_until будит с опозданием на квант планировщика: спим до дедлайна−запас, остаток — yield.
+        // [RU] На Windows даже с таймером 1 мс (TimerResolutionGuard) Sleep опаздывает до тика, поэтому запас 2 мс.
+        // [EN] sleep_until wakes up a scheduler quantum late: sleep until deadline−margin, yield for the rest.
+        // [EN] On Windows, even with a 1 ms timer (TimerResolutionGuard), Sleep runs up to a tick late, hence a 2 ms margin.
+        auto coarse=deadline-sleepMargin;
+        if(coarse>now) std::this_thread::sleep_until(coarse);
+        while((now=SchedClock::now())<deadline) std::this_thread::yield();
+        overshoot.record(std::chrono::duration_cast<std::chrono::nanoseconds>(now-deadline).count());
+        return deadline;
+    }
+    void print(FILE*f)const{                   // [RU] Итог на выходе
+                                               // [EN] Summary on exit
+        double hz = period.count() ? 1.0/std::chrono::duration<double>(period).count() : 0.0;
+        std::fprintf(f,"target: %s%.0f FPS, frames: %llu, dropped: %llu\n",hz>0?"":"uncapped ",hz,(unsigned long long)frames,(unsigned long long)dropped);
+        Histogram::printHeader(f); render.print(f,"render"); overshoot.print(f,"overshoot"); latency.print(f,"latency");
+    }
+};
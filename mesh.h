@@ -0,0 +1,265 @@
+// [RU] === mesh.h — меши: отображение файла в память, бинарный STL и Wavefront OBJ → индексные буферы с нормалями граней ===
+// [EN] === mesh.h — meshes: memory-mapped files, binary STL and Wavefront OBJ → indexed buffers with face normals ===
+#pragma once
+#include "render.h"                            // [RU] Vec3, cross/norm, грани куба
+                                               // [EN] Vec3, cross/norm, cube faces
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#ifdef _WIN32
+#include <windows.h>                           // [RU] CreateFileMapping/MapViewOfFile
+                                               // [EN] CreateFileMapping/MapViewOfFile
+#else
+#include <fcntl.h>                             // [RU] open
+                                               // [EN] open
+#include <sys/mman.h>                          // [RU] mmap/madvise
+                                               // [EN] mmap/madvise
+#include <sys/stat.h>                          // [RU] fstat — размер файла
+                                               // [EN] fstat — file size
+#include <unistd.h>                            // [RU] close
+                                               // [EN] close
+#endif
+
+// [RU] --- Файл, отображённый в память только для чтения: разбор идёт прямо по страницам ОС, без копий и read() ---
+// [EN] --- Read-only memory-mapped file: parsing runs straight over OS pages, with no copies and no read() ---
+struct MappedFile{
+    const char*data=nullptr; size_t size=0;
+#ifdef _WIN32
+    HANDLE file=INVALID_HANDLE_VALUE, map=nullptr;
+#else
+    int fd=-1;
+#endif
+    MappedFile(){}
+    MappedFile(const MappedFile&)=delete; MappedFile&operator=(const MappedFile&)=delete;
+    ~MappedFile(){ close(); }
+
+    bool open(const char*path){                // [RU] false — нет файла или отображение не удалось
+                                               // [EN] false — no such file or the mapping failed
+        close();
+#ifdef _WIN32
+        file=CreateFileA(path,GENERIC_READ,FILE_SHARE_READ,nullptr,OPEN_EXISTING,FILE_FLAG_SEQUENTIAL_SCAN,nullptr);
+        if(file==INVALID_HANDLE_VALUE) return false;
+        LARGE_INTEGER sz; if(!GetFileSizeEx(file,&sz)){ close(); return false; }
+        size=(size_t)sz.QuadPart; if(!size) return true; // [RU] Пустой файл не отображается — это не ошибка
+                                                         // [EN] An empty file cannot be mapped — not an error
+        map=CreateFileMappingA(file,nullptr,PAGE_READONLY,0,0,nullptr); if(!map){ close(); return false; }
+        data=(const char*)MapViewOfFile(map,FILE_MAP_READ,0,0,0); if(!data){ close(); return false; }
+#else
+        fd=::open(path,O_RDONLY); if(fd<0) return false;
+        struct stat st; if(fstat(fd,&st)!=0){ close(); return false; }
+        size=(size_t)st.st_size; if(!size) return true;
+        void*p=mmap(nullptr,size,PROT_READ,MAP_PRIVATE,fd,0); if(p==MAP_FAILED){ size=0; close(); return false; }
+        madvise(p,size,MADV_SEQUENTIAL);       // [RU] Один проход от начала до конца — агрессивное упреждающее чтение
+                                               // [EN] A single front-to-back pass — aggressive read-ahead
+        data=(const char*)p;
+#endif
+        return true;
+    }
+    void close(){
+#ifdef _WIN32
+        if(data) UnmapViewOfFile(data);
+        if(map) CloseHandle(map);
+        if(file!=INVALID_HANDLE_VALUE) CloseHandle(file);
+        map=nullptr; file=INVALID_HANDLE_VALUE;
+#else
+        if(data) munmap((void*)data,size);
+        if(fd>=0) ::close(fd);
+        fd=-1;
+#endif
+        data=nullptr; size=0;
+    }
+};
+
+// [RU] --- Меш: уникальные вершины + по 3 индекса на треугольник + единичная нормаль каждого треугольника ---
+// [EN] --- Mesh: unique vertices + 3 indices per triangle + a unit normal for every triangle ---
+// [RU] Вершины лежат в порядке первого использования — соседние треугольники читают соседние строки кеша.
+// [EN] Vertices are stored in first-use order — neighbouring triangles read neighbouring cache lines.
+struct Mesh{
+    std::vector<Vec3> pos;                     // [RU] Вершины в пространстве объекта
+                                               // [EN] Vertices in object space
+    std::vector<uint32_t> idx;                 // [RU] Треугольники: idx[3t..3t+2]
+                                               // [EN] Triangles: idx[3t..3t+2]
+    std::vector<Vec3> faceN;                   // [RU] Нормаль треугольника (наружу при обходе против часовой)
+                                               // [EN] Triangle normal (outward for counter-clockwise winding)
+    Vec3 bmin{0,0,0}, bmax{0,0,0};             // [RU] Габариты
+                                               // [EN] Bounds
+
+    size_t tris()const{ return idx.size()/3; }
+    void finish(){                             // [RU] Нормали и габариты — один раз при загрузке, не в кадре
+                                               // [EN] Normals and bounds — once at load time, not per frame
+        faceN.resize(tris());
+        for(size_t t=0;t<faceN.size();++t){
+            const Vec3&a=pos[idx[3*t]]; const Vec3&b=pos[idx[3*t+1]]; const Vec3&c=pos[idx[3*t+2]];
+            Vec3 n=cross(sub(b,a),sub(c,a)); float l2=dot(n,n);
+            faceN[t] = l2>0 ? mul(n,1.0f/std::sqrt(l2)) : Vec3{0,0,0}; // [RU] Вырожденный: нулевая нормаль → всегда отсекается
+                                                                       // [EN] Degenerate: a zero normal → always culled
+        }
+        if(pos.empty()){ bmin=bmax={0,0,0}; return; }
+        bmin=bmax=pos[0];
+        for(const Vec3&p:pos){ bmin={std::min(bmin.x,p.x),std::min(bmin.y,p.y),std::min(bmin.z,p.z)};
+                               bmax={std::max(bmax.x,p.x),std::max(bmax.y,p.y),std::max(bmax.z,p.z)}; }
+    }
+    void fitUnit(){                            // [RU] Центр в начало координат, наибольшая полуось = 1 — как у куба
+                                               // [EN] Center at the origin, largest half-extent = 1 — like the cube
+        Vec3 c=mul(add(bmin,bmax),0.5f), h=mul(sub(bmax,bmin),0.5f);
+        float r=std::max(h.x,std::max(h.y,h.z)); float s = r>0 ? 1.0f/r : 1.0f;
+        for(Vec3&p:pos) p=mul(sub(p,c),s);
+        bmin=mul(sub(bmin,c),s); bmax=mul(sub(bmax,c),s);
+    }
+};
+
+// [RU] --- Сварка вершин: хеш-таблица с открытой адресацией по битам координат, без аллокаций на вершину ---
+// [EN] --- Vertex welding: open-addressing hash table over coordinate bits, no per-vertex allocations ---
+struct VertexWelder{
+    std::vector<uint32_t> slots;               // [RU] Индекс вершины+1, 0 — пусто
+                                               // [EN] Vertex index+1, 0 — empty
+    static uint32_t bits(float f){ uint32_t u; std::memcpy(&u,&f,4); return u==0x80000000u ? 0u : u; } // [RU] -0 и +0 — одна вершина
+                                                                                                         // [EN] -0 and +0 are one vertex
+    static uint32_t hash(uint32_t x,uint32_t y,uint32_t z){
+        uint32_t h=x*0x9E3779B1u ^ y*0x85EBCA77u ^ z*0xC2B2AE3Du; h^=h>>15; h*=0x2C1B3C6Du; h^=h>>12; return h;
+    }
+    void reserve(size_t verts){ size_t cap=64; while(cap<verts*2) cap<<=1; slots.assign(cap,0); } // [RU] Заполнение ≤ 1/2
+                                                                                                  // [EN] Load factor ≤ 1/2
+    uint32_t add(const Vec3&v,std::vector<Vec3>&pos){
+        if((pos.size()+1)*2>slots.size()) grow(pos);
+        const uint32_t x=bits(v.x),y=bits(v.y),z=bits(v.z); const size_t mask=slots.size()-1;
+        for(size_t i=hash(x,y,z)&mask;;i=(i+1)&mask){
+            uint32_t s=slots[i];
+            if(!s){ pos.push_back(v); slots[i]=(uint32_t)pos.size(); return (uint32_t)pos.size()-1; }
+            const Vec3&p=pos[s-1]; if(bits(p.x)==x&&bits(p.y)==y&&bits(p.z)==z) return s-1;
+        }
+    }
+private:
+    void grow(const std::vector<Vec3>&pos){    // [RU] Удвоение и перераскладка уже сваренных вершин
+                                               // [EN] Double and re-insert the vertices welded so far
+        slots.assign(std::max<size_t>(64,slots.size()*2),0); const size_t mask=slots.size()-1;
+        for(size_t k=0;k<pos.size();++k){ const Vec3&p=pos[k];
+            size_t i=hash(bits(p.x),bits(p.y),bits(p.z))&mask; while(slots[i]) i=(i+1)&mask; slots[i]=(uint32_t)k+1; }
+    }
+};
+
+// [RU] --- Бинарный STL: 80 байт заголовка, uint32 число треугольников, по 50 байт на треугольник ---
+// [EN] --- Binary STL: an 80-byte header, a uint32 triangle count, 50 bytes per triangle ---
+// [RU] Нормаль из файла не используется: её часто пишут нулевой — считаем по вершинам.
+// [EN] The stored normal is ignored: it is often written as zero — it is computed from the vertices.
+static bool loadStl(const MappedFile&f,Mesh&m,std::string&err){
+    if(f.size<84){ err="STL: file is too short"; return false; }
+    uint32_t n; std::memcpy(&n,f.data+80,4);
+    if(84+(uint64_t)n*50>f.size){
+        err = !std::memcmp(f.data,"solid",5) ? "STL: ASCII STL is not supported, only binary" : "STL: truncated triangle list";
+        return false;
+    }
+    m.pos.clear(); m.idx.resize((size_t)n*3);
+    VertexWelder w; w.reserve((size_t)n/2+8);  // [RU] У замкнутой сетки вершин ≈ вдвое меньше, чем треугольников
+                                               // [EN] A closed mesh has about half as many vertices as triangles
+    m.pos.reserve((size_t)n/2+8);
+    const char*p=f.data+84;
+    for(uint32_t t=0;t<n;++t,p+=50)
+        for(int k=0;k<3;++k){ Vec3 v; std::memcpy(&v,p+12+12*k,12); m.idx[(size_t)t*3+k]=w.add(v,m.pos); }
+    m.finish();
+    return true;
+}
+
+// [RU] --- Разбор чисел OBJ прямо по отображённой памяти: без strtof (нет '\0' в конце) и без локали ---
+// [EN] --- OBJ number parsing straight over mapped memory: no strtof (no trailing '\0') and no locale ---
+static inline void skipBlanks(const char*&p,const char*end){ while(p<end&&(*p==' '||*p=='\t')) ++p; }
+static inline bool parseFloat(const char*&p,const char*end,float&out){
+    static const double p10[]={1e0,1e1,1e2,1e3,1e4,1e5,1e6,1e7,1e8,1e9,1e10,1e11,1e12,1e13,1e14,1e15,1e16,1e17,1e18,1e19,1e20,1e21,1e22};
+    skipBlanks(p,end);
+    bool neg=false; if(p<end&&(*p=='-'||*p=='+')){ neg=*p=='-'; ++p; }
+    uint64_t mant=0; int digits=0, e10=0; bool any=false;
+    for(;p<end&&(unsigned)(*p-'0')<10;++p){ any=true; if(digits<19){ mant=mant*10+(uint64_t)(*p-'0'); if(mant) ++digits; } else ++e10; }
+    if(p<end&&*p=='.') for(++p;p<end&&(unsigned)(*p-'0')<10;++p){ any=true; if(digits<19){ mant=mant*10+(uint64_t)(*p-'0'); if(mant) ++digits; --e10; } }
+    if(!any) return false;
+    if(p<end&&(*p=='e'||*p=='E')){ ++p;
+        bool en=false; if(p<end&&(*p=='-'||*p=='+')){ en=*p=='-'; ++p; }
+        int e=0; bool ed=false; for(;p<end&&(unsigned)(*p-'0')<10;++p){ ed=true; if(e<10000) e=e*10+(*p-'0'); }
+        if(!ed) return false;
+        e10 += en ? -e : e;
+    }
+    double v=(double)mant;
+    if(e10<0) v = e10>=-22 ? v/p10[-e10] : v*std::pow(10.0,e10); // [RU] Точные степени 10 из таблицы — точность как у strtod на типичных данных
+    else if(e10>0) v = e10<=22 ? v*p10[e10] : v*std::pow(10.0,e10); // [EN] Exact powers of 10 from the table — strtod-grade on typical data
+    out=(float)(neg?-v:v);
+    return true;
+}
+static inline bool parseIndex(const char*&p,const char*end,int64_t&out){ // [RU] int64_t: long на Windows — 32 бита
+                                                                          // [EN] int64_t: long is 32 bits on Windows
+    bool neg=false; if(p<end&&*p=='-'){ neg=true; ++p; }
+    int64_t v=0; bool any=false;
+    for(;p<end&&(unsigned)(*p-'0')<10;++p){ any=true; v=v*10+(*p-'0');
+        if(v>(int64_t)UINT32_MAX) return false; } // [RU] Больше uint32 — ошибка разбора, а не тихий перенос
+                                                  // [EN] Beyond uint32 — a parse error, not a silent wrap
+    out = neg ? -v : v; return any;
+}
+
+// [RU] --- Wavefront OBJ: v и f (v, v/vt, v//vn, v/vt/vn; отрицательные индексы), многоугольники — веером ---
+// [EN] --- Wavefront OBJ: v and f (v, v/vt, v//vn, v/vt/vn; negative indices), polygons as fans ---
+// [RU] Остальные директивы (vt, vn, o, g, s, usemtl, …) пропускаются; вершины уже индексированы — сварка не нужна.
+// [EN] Other directives (vt, vn, o, g, s, usemtl, …) are skipped; vertices are already indexed — no welding needed.
+static bool loadObj(const MappedFile&f,Mesh&m,std::string&err){
+    m.pos.clear(); m.idx.clear();
+    m.pos.reserve(f.size/40); m.idx.reserve(f.size/8); // [RU] Грубая оценка по размеру — меньше перевыделений
+                                                       // [EN] Rough estimate from the size — fewer reallocations
+    const char*p=f.data, *end=f.data+f.size; size_t line=1;
+    auto fail=[&](const char*what){ err="OBJ line "+std::to_string(line)+": "+what; return false; };
+    while(p<end){
+        skipBlanks(p,end);
+        if(p+1<end&&p[0]=='v'&&(p[1]==' '||p[1]=='\t')){ p+=2;
+            Vec3 v; if(!parseFloat(p,end,v.x)||!parseFloat(p,end,v.y)||!parseFloat(p,end,v.z)) return fail("bad vertex");
+            m.pos.push_back(v);                // [RU] Необязательные w/цвет пропускаются ниже вместе с концом строки
+                                               // [EN] Optional w/color are skipped below along with the end of the line
+        } else if(p+1<end&&p[0]=='f'&&(p[1]==' '||p[1]=='\t')){ p+=2;
+            uint32_t first=0, prev=0; int cnt=0;
+            for(;;){
+                skipBlanks(p,end);
+                if(p>=end||*p=='\n'||*p=='\r'||*p=='#') break;
+                int64_t i; if(!parseIndex(p,end,i)||i==0) return fail("bad face index");
+                int64_t r = i>0 ? i-1 : (int64_t)m.pos.size()+i; // [RU] Отрицательный — относительно уже прочитанных вершин
+                                                                 // [EN] Negative — relative to the vertices read so far
+                if(r<0||r>=(int64_t)UINT32_MAX) return fail("face index out of range");
+                while(p<end&&*p!=' '&&*p!='\t'&&*p!='\n'&&*p!='\r') ++p; // [RU] Пропуск /vt/vn
+                                                                         // [EN] Skip /vt/vn
+                const uint32_t cur=(uint32_t)r;
+                if(cnt==0) first=cur;
+                else if(cnt>=2){ m.idx.push_back(first); m.idx.push_back(prev); m.idx.push_back(cur); }
+                prev=cur; ++cnt;
+            }
+            if(cnt<3) return fail("face with fewer than 3 vertices");
+        }
+        const char*nl=(const char*)std::memchr(p,'\n',(size_t)(end-p)); // [RU] К следующей строке
+                                                                         // [EN] On to the next line
+        p = nl ? nl+1 : end; ++line;
+    }
+    for(uint32_t i:m.idx) if(i>=m.pos.size()){ err="OBJ: face index out of range"; return false; } // [RU] Ссылки вперёд проверяем в конце
+                                                                                                   // [EN] Forward references are checked at the end
+    m.finish();
+    return true;
+}
+
+// [RU] --- Загрузка по расширению (.stl/.obj), иначе по содержимому ---
+// [EN] --- Load by extension (.stl/.obj), otherwise by content ---
+static inline bool loadMesh(const char*path,Mesh&m,std::string&err){
+    MappedFile f;
+    if(!f.open(path)){ err=std::string("cannot open ")+path; return false; }
+    size_t len=std::strlen(path); auto ext=[&](const char*e){ return len>=4&&(path[len-4]|0x20)==e[0]&&(path[len-3]|0x20)==e[1]&&(path[len-2]|0x20)==e[2]&&(path[len-1]|0x20)==e[3]; };
+    bool stl = ext(".stl") || (!ext(".obj") && f.size>=84 && [&]{ uint32_t n; std::memcpy(&n,f.data+80,4); return 84+(uint64_t)n*50==f.size; }());
+    return stl ? loadStl(f,m,err) : loadObj(f,m,err);
+}
+
+// [RU] --- Куб как меш: те же грани cubeFaces, по два треугольника, 8 общих вершин ---
+// [EN] --- The cube as a mesh: the same cubeFaces, two triangles each, 8 shared vertices ---
+static inline Mesh cubeMesh(){
+    static const float cu[4]={-1,1,1,-1}, cv[4]={-1,-1,1,1};
+    Mesh m; VertexWelder w; w.reserve(8);
+    for(const Face&f:cubeFaces){
+        uint32_t q[4]; for(int k=0;k<4;++k) q[k]=w.add(pointOnFace(f,cu[k],cv[k]),m.pos);
+        Vec3 n=cross(sub(m.pos[q[1]],m.pos[q[0]]),sub(m.pos[q[2]],m.pos[q[0]]));
+        if(dot(n,mul(f.axis,f.sign))<0){ std::swap(q[1],q[3]); } // [RU] Обход против часовой снаружи
+                                                                 // [EN] Counter-clockwise seen from outside
+        const uint32_t t[6]={q[0],q[1],q[2],q[0],q[2],q[3]}; m.idx.insert(m.idx.end(),t,t+6);
+    }
+    m.finish();
+    return m;
+}
@@ -0,0 +1,67 @@
+// [RU] === pipeline.h — единая точка входа рендера кадра: выбор растеризатора ===
+// [EN] === pipeline.h — single entry point for rendering a frame: rasterizer selection ===
+#pragma once
+#include "render.h"                            // [RU] Сэмплер (исходный способ)
+                                               // [EN] Sampler (the original method)
+#include "raster.h"                            // [RU] Построчный растеризатор
+                                               // [EN] Scanline rasterizer
+#include "sampler.h"                           // [RU] Сэмплер на таблицах (режим по умолчанию для --raster sampler)
+                                               // [EN] Table-driven sampler (what --raster sampler runs)
+#include "simd.h"                              // [RU] Пакетное SoA-ядро преобразования
+                                               // [EN] Batch SoA transform kernel
+#include "tiles.h"                             // [RU] Многопоточный тайловый растеризатор
+                                               // [EN] Multithreaded tiled rasterizer
+#include "scene.h"                             // [RU] Меши и сцены из экземпляров
+                                               // [EN] Meshes and instanced scenes
+#include <cstring>                             // [RU] Разбор имени режима
+                                               // [EN] Mode name parsing
+
+// [RU] --- Рендерер: держит состояние между кадрами (сетки, скретч-буферы) ---
+// [EN] --- Renderer: holds state across frames (grids, scratch buffers) ---
+struct Renderer{
+    TableSampler sampler;                      // [RU] Ось сетки и таблица затенения
+                                               // [EN] Grid axis and shade table
+    BatchSampler batch;                        // [RU] Сетки граней и выход SIMD-ядра
+                                               // [EN] Face grids and SIMD kernel output
+    TiledRaster tiled;                         // [RU] Пул потоков и корзины тайлов
+                                               // [EN] Thread pool and tile bins
+    MeshRaster meshes;                         // [RU] Скретч вершин экземпляра и статистика треугольников
+                                               // [EN] Instance vertex scratch and triangle statistics
+    void render(Frame&fr,const Projector&proj,const RenderParams&rp,const Pose&ps){
+        switch(rp.mode){
+        case RasterMode::Sampler:  sampler.render(fr,proj,rp,ps); break;
+        case RasterMode::Scanline: rasterCube(fr,proj,rp,ps); break;
+        case RasterMode::Batch:    batch.render(fr,proj,rp,ps); break;
+        case RasterMode::Tiled:    tiled.render(fr,proj,rp,ps); break;
+        }
+    }
+    // [RU] Сцена мешей: сэмплер и batch устроены только под грани куба — для мешей это scanline, tiled — по тайлам
+    // [EN] Mesh scene: sampler and batch only know cube faces — for meshes they mean scanline, tiled stays tiled
+    void render(Frame&fr,const Projector&proj,const RenderParams&rp,const Scene&sc,float t,float rotSpeed){
+        meshes.build(tiled.prims,proj,rp,sc,t,rotSpeed); // [RU] Буфер примитивов тайлового растеризатора — общий
+                                                         // [EN] The tiled rasterizer's primitive buffer is shared
+        if(rp.mode==RasterMode::Tiled){ tiled.renderPrims(fr); return; }
+        fr.clear();
+        for(int i=0;i<(int)tiled.prims.size();++i){ TRACE_SCOPE(TS_FACE,i); fillPrim(fr,tiled.prims[(size_t)i],0,0,fr.W,fr.H); }
+    }
+};
+
+// [RU] --- Имена режимов и ISA для командной строки ---
+// [EN] --- Mode and ISA names for the command line ---
+static inline const char* rasterModeName(RasterMode m){
+    switch(m){ case RasterMode::Sampler: return "sampler"; case RasterMode::Batch: return "batch"; case RasterMode::Tiled: return "tiled"; default: return "scanline"; }
+}
+static inline bool parseRasterMode(const char*s,RasterMode&m){
+    if(!std::strcmp(s,"sampler")){ m=RasterMode::Sampler; return true; }
+    if(!std::strcmp(s,"scanline")){ m=RasterMode::Scanline; return true; }
+    if(!std::strcmp(s,"batch")){ m=RasterMode::Batch; return true; }
+    if(!std::strcmp(s,"tiled")){ m=RasterMode::Tiled; return true; }
+    return false;
+}
+static inline bool parseIsa(const char*s,Isa&i){
+    if(!std::strcmp(s,"auto")){ i=detectIsa(); return true; }
+    if(!std::strcmp(s,"scalar")){ i=Isa::Scalar; return true; }
+    if(!std::strcmp(s,"sse2")){ i=Isa::SSE2; return true; }
+    if(!std::strcmp(s,"avx2")){ i=Isa::AVX2; return true; }
+    return false;
+}
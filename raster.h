@@ -0,0 +1,138 @@
+// [RU] === raster.h — построчный растеризатор выпуклых граней с перспективно-корректной 1/z ===
+// [EN] === raster.h — scanline rasterizer for convex faces with perspective-correct 1/z ===
+#pragma once
+#include "render.h"                            // [RU] Vec3, Projector, Frame, свет граней
+                                               // [EN] Vec3, Projector, Frame, face lighting
+
+// [RU] --- Вершина на экране: непрерывные X/Y в ячейках и обратная глубина ---
+// [EN] --- Screen vertex: continuous X/Y in cells and inverse depth ---
+struct ScreenVert{ float X,Y,w; };
+
+// [RU] --- Отсечение выпуклого многоугольника ближней плоскостью (Сазерленд–Ходжмен) ---
+// [EN] --- Clip a convex polygon against the near plane (Sutherland–Hodgman) ---
+static inline int clipNear(const Vec3*in,int n,float nearZ,Vec3*out){ // [RU] out — минимум n+1 вершин
+                                                                      // [EN] out — at least n+1 vertices
+    int m=0;
+    for(int i=0;i<n;++i){ const Vec3&a=in[i]; const Vec3&b=in[(i+1)%n];
+        bool ina=a.z>nearZ, inb=b.z>nearZ;     // [RU] Тот же критерий, что у сэмплера: z>nearZ
+                                               // [EN] Same criterion as the sampler: z>nearZ
+        if(ina) out[m++]=a;
+        if(ina!=inb){ const Vec3&p=ina?a:b, &q=ina?b:a; // [RU] Всегда от внутренней вершины к внешней: соседние грани проходят общее ребро
+                                                        // [RU] в разные стороны, но получают одну и ту же точку — без щелей на ребре
+                                                        // [EN] Always from the inside vertex to the outside one: neighbouring faces walk a shared
+                                                        // [EN] edge in opposite directions but get the very same point — no cracks along it
+            float t=(nearZ-p.z)/(q.z-p.z); out[m++]={p.x+(q.x-p.x)*t, p.y+(q.y-p.y)*t, nearZ}; } // [RU] Точка на плоскости
+                                                                                                  // [EN] Point on the plane
+    }
+    return m;
+}
+
+// [RU] --- Примитив: выпуклый многоугольник на экране, готовый к заливке ---
+// [EN] --- Primitive: a convex on-screen polygon ready to be filled ---
+struct Prim{
+    ScreenVert v[8]; int n;                    // [RU] Вершины после отсечения ближней плоскостью
+                                               // [EN] Vertices after near-plane clipping
+    float A,B,C;                               // [RU] Плоскость 1/z: w=A·X+B·Y+C (bias уже внутри C)
+                                               // [EN] 1/z plane: w=A·X+B·Y+C (bias already folded into C)
+    int x0,y0,x1,y1;                           // [RU] Покрываемые ячейки [x0,x1)×[y0,y1) — для разбиения на тайлы
+                                               // [EN] Covered cells [x0,x1)×[y0,y1) — for tile binning
+    Cell c;                                    // [RU] Символ и цвет грани
+                                               // [EN] Face character and color
+};
+
+// [RU] --- Подготовка примитива: плоскость глубины и габариты; false — нечего заливать ---
+// [EN] --- Primitive setup: depth plane and bounds; false — nothing to fill ---
+static bool setupPrim(Prim&p,const ScreenVert*v,int n,Cell c,float bias,int W,int H){
+    float xmin=v[0].X,xmax=v[0].X,ymin=v[0].Y,ymax=v[0].Y;
+    for(int i=1;i<n;++i){ xmin=std::min(xmin,v[i].X); xmax=std::max(xmax,v[i].X); ymin=std::min(ymin,v[i].Y); ymax=std::max(ymax,v[i].Y); }
+    xmin=std::clamp(xmin,-1.0f,(float)W+1.0f); xmax=std::clamp(xmax,-1.0f,(float)W+1.0f); // [RU] Защита int от огромных X/Y у ближней плоскости
+    ymin=std::clamp(ymin,-1.0f,(float)H+1.0f); ymax=std::clamp(ymax,-1.0f,(float)H+1.0f); // [EN] Keep int safe from huge X/Y near the near plane
+    p.x0=std::max(0,(int)std::ceil(xmin-0.5f)); p.x1=std::min(W,(int)std::ceil(xmax-0.5f)); // [RU] Центры в [min,max)
+    p.y0=std::max(0,(int)std::ceil(ymin-0.5f)); p.y1=std::min(H,(int)std::ceil(ymax-0.5f)); // [EN] Centers in [min,max)
+    if(p.x0>=p.x1||p.y0>=p.y1) return false;   // [RU] Вне экрана или не накрывает ни одного центра — до дорогой плоскости
+                                               // [EN] Off screen or covers no cell center — before the costly plane
+    double best=0; int bi=-1;                  // [RU] Плоскость 1/z — по самому большому треугольнику веера
+                                               // [EN] 1/z plane — from the largest fan triangle
+    for(int i=1;i+1<n;++i){ double ar=(double)(v[i].X-v[0].X)*(v[i+1].Y-v[0].Y)-(double)(v[i+1].X-v[0].X)*(v[i].Y-v[0].Y);
+        if(std::abs(ar)>std::abs(best)){ best=ar; bi=i; } }
+    if(bi<0||std::abs(best)<1e-9) return false; // [RU] Вырожденная (ребром к камере) — нечего заливать
+                                                // [EN] Degenerate (edge-on) — nothing to fill
+    const ScreenVert&p0=v[0]; const ScreenVert&p1=v[bi]; const ScreenVert&p2=v[bi+1];
+    double e1x=p1.X-p0.X,e1y=p1.Y-p0.Y,e1w=p1.w-p0.w, e2x=p2.X-p0.X,e2y=p2.Y-p0.Y,e2w=p2.w-p0.w;
+    // [RU] 1/z аффинна в экранных координатах — это и есть перспективная корректность
+    // [EN] 1/z is affine in screen space — that is what makes it perspective-correct
+    p.A=(float)((e1w*e2y-e2w*e1y)/best); p.B=(float)((e1x*e2w-e2x*e1w)/best);
+    p.C=(float)(p0.w-(double)p.A*p0.X-(double)p.B*p0.Y)+bias;
+
+    std::copy(v,v+n,p.v); p.n=n; p.c=c;
+    return true;
+}
+
+// [RU] --- Заливка примитива внутри прямоугольника [rx0,rx1)×[ry0,ry1): центр ячейки внутри → ячейка покрыта ---
+// [EN] --- Fill a primitive inside the rectangle [rx0,rx1)×[ry0,ry1): cell center inside → cell covered ---
+// [RU] Интервалы полуоткрытые [xl,xr) и [yTop,yBot): общее ребро соседних граней не даёт ни дыр, ни двойной записи.
+// [EN] Half-open spans [xl,xr) and [yTop,yBot): an edge shared by neighbouring faces leaves neither holes nor double writes.
+// [RU] Каждая ячейка считается одинаково при любом прямоугольнике — тайлы дают тот же кадр, что и полный экран.
+// [EN] Each cell is computed the same for any rectangle — tiles yield the same frame as the full screen.
+static void fillPrim(Frame&fr,const Prim&p,int rx0,int ry0,int rx1,int ry1){
+    const ScreenVert*v=p.v; const int n=p.n;
+    const int ya=std::max(p.y0,ry0), yb=std::min(p.y1,ry1);
+    for(int y=ya;y<yb;++y){
+        const float yc=(float)y+0.5f;
+        float xl=1e30f,xr=-1e30f;              // [RU] Пересечение строки с рёбрами — у выпуклой фигуры ровно отрезок
+                                               // [EN] Row/edge intersections — a convex shape yields a single span
+        for(int i=0;i<n;++i){ const ScreenVert*a=&v[i]; const ScreenVert*b=&v[(i+1)%n];
+            if(a->Y==b->Y) continue;           // [RU] Горизонтальные рёбра не пересекают центры
+                                               // [EN] Horizontal edges never cross centers
+            if(a->Y>b->Y) std::swap(a,b);      // [RU] Единый порядок → общее ребро считается одинаково с обеих сторон
+                                               // [EN] Canonical order → a shared edge evaluates identically on both sides
+            if(yc<a->Y||yc>=b->Y) continue;
+            float x=a->X+(yc-a->Y)*(b->X-a->X)/(b->Y-a->Y);
+            xl=std::min(xl,x); xr=std::max(xr,x);
+        }
+        if(xl>=xr) continue;
+        xl=std::clamp(xl,-1.0f,(float)fr.W+1.0f); xr=std::clamp(xr,-1.0f,(float)fr.W+1.0f);
+        int x0=std::max(rx0,(int)std::ceil(xl-0.5f)), x1=std::min(rx1,(int)std::ceil(xr-0.5f));
+        TRACE_COUNT(TC_SAMPLES,std::max(0,x1-x0));
+        const float wRow=p.B*yc+p.C;
+        const size_t row=(size_t)y*(size_t)fr.W;
+        for(int x=x0;x<x1;++x){
+            float w=p.A*((float)x+0.5f)+wRow;  // [RU] Обратная глубина в центре ячейки
+                                               // [EN] Inverse depth at the cell center
+            fr.plot(row+(size_t)x,w,p.c);      // [RU] Z-тест — пишем только ближнее
+                                               // [EN] Z-test — write only the nearer
+        }
+    }
+}
+
+// [RU] --- Примитивы куба: 4 угла на грань вместо ~4000 точек; возвращает их число (≤6) ---
+// [EN] --- Cube primitives: 4 corners per face instead of ~4000 points; returns their count (≤6) ---
+static int cubePrims(Prim*out,const Projector&proj,const RenderParams&rp,const Pose&ps){
+    static const float cu[4]={-1,1,1,-1}, cv[4]={-1,-1,1,1}; // [RU] Обход углов (u,v) по контуру
+                                                             // [EN] Corner (u,v) walk around the outline
+    TRACE_SCOPE(TS_SETUP,-1);
+    int np=0;
+    for(int faceIndex=0; faceIndex<6; ++faceIndex){
+        const Face& f = cubeFaces[faceIndex];
+        float shadeF; if(!litFace(faceIndex,ps,rp,shadeF)) continue; // [RU] Отсечение задних граней + свет
+                                                                     // [EN] Back-face culling + lighting
+        Vec3 q[4];
+        for(int k=0;k<4;++k) q[k]=add(rotateAll(mul(pointOnFace(f,cu[k],cv[k]),rp.cubeScale), ps.sx,ps.cx,ps.sy,ps.cy,ps.sz,ps.cz),{0,0,rp.camZ});
+        Vec3 cl[8]; int n=clipNear(q,4,rp.nearZ,cl); if(n<3) continue; // [RU] Целиком за ближней плоскостью
+                                                                       // [EN] Entirely behind the near plane
+        ScreenVert sv[8];
+        for(int k=0;k<n;++k){ proj.toScreenF(cl[k],sv[k].X,sv[k].Y); sv[k].w=1.0f/cl[k].z; }
+        if(setupPrim(out[np],sv,n,Cell{shadeGlyph(rp,shadeF),faceColors[faceIndex]},1e-5f*(float)faceIndex,proj.W,proj.H)) ++np; // [RU] Тот же bias, что у сэмплера
+                                                                                                                                    // [EN] Same bias as the sampler
+    }
+    return np;
+}
+
+// [RU] --- Куб через растеризатор, один поток, весь экран ---
+// [EN] --- Cube via the rasterizer, one thread, whole screen ---
+static void rasterCube(Frame&fr,const Projector&proj,const RenderParams&rp,const Pose&ps){
+    fr.clear();                                // [RU] Чистый лист на каждый кадр
+                                               // [EN] Clean slate every frame
+    Prim prims[6]; int np=cubePrims(prims,proj,rp,ps);
+    for(int i=0;i<np;++i){ TRACE_SCOPE(TS_FACE,i); fillPrim(fr,prims[i],0,0,fr.W,fr.H); }
+}
@@ -0,0 +1,256 @@
+// [RU] === record.h — запись и воспроизведение кадров: фоновый писатель, ключевые кадры + RLE-дельты, экспорт в asciicast v2 ===
+// [EN] === record.h — frame recording and replay: background writer, keyframes + RLE deltas, asciicast v2 export ===
+#pragma once
+#include "render.h"                            // [RU] Frame, Cell
+                                               // [EN] Frame, Cell
+#include "ansi.h"                              // [RU] Экспорт: кадр → ANSI-дельта
+                                               // [EN] Export: frame → ANSI delta
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+// [RU] --- Формат файла (little-endian) ---
+// [EN] --- File format (little-endian) ---
+// [RU] "CUBEREC1", затем записи: u8 тип ('K' ключевой / 'D' дельта), u32 номер кадра, u64 время от начала (нс),
+// [RU] u16 W, u16 H, u32 длина данных, данные. Ячейка — байт символа + байт цвета.
+// [RU]   K: серии (varint длина, символ, цвет) на весь кадр;
+// [RU]   D: (varint пропуск неизменных, varint длина серии, символ, цвет) до конца данных.
+// [RU] Номера кадров идут с пропусками, если писатель не успевал: дельта всегда против последнего записанного.
+// [EN] "CUBEREC1", then records: u8 type ('K' keyframe / 'D' delta), u32 frame number, u64 time since start (ns),
+// [EN] u16 W, u16 H, u32 payload length, payload. A cell is a character byte + a color byte.
+// [EN]   K: runs (varint length, character, color) over the whole frame;
+// [EN]   D: (varint skip of unchanged cells, varint run length, character, color) up to the end of the payload.
+// [EN] Frame numbers have gaps when the writer fell behind: a delta is always against the last written frame.
+static const char recMagic[8]={'C','U','B','E','R','E','C','1'};
+
+static inline uint16_t packCell(Cell c){ return (uint16_t)((uint8_t)c.ch|(uint16_t)((c.attr&0xFF)<<8)); }
+static inline Cell unpackCell(uint16_t v){ return Cell{(char)(v&0xFF),(uint16_t)(v>>8)}; }
+static inline void putVarint(std::vector<uint8_t>&o,uint32_t v){ while(v>=0x80){ o.push_back((uint8_t)(v|0x80)); v>>=7; } o.push_back((uint8_t)v); }
+static inline bool getVarint(const uint8_t*&p,const uint8_t*end,uint32_t&v){
+    v=0; for(int s=0;s<35&&p<end;s+=7){ uint8_t b=*p++; v|=(uint32_t)(b&0x7F)<<s; if(!(b&0x80)) return true; }
+    return false;
+}
+
+// [RU] --- Запись: поток рендера только публикует свой кадр, снимок и кодирование — в фоновом потоке ---
+// [EN] --- Recording: the render thread only publishes its frame, the snapshot and encoding run on the background thread ---
+// [RU] Буферы не вращаются через поток рендера: он рисует всё время в один и тот же горячий кадр. Писатель копирует
+// [RU] его в упакованный снимок в паузе до следующего кадра и дальше кодирует и пишет уже снимок. Поток рендера
+// [RU] платит две атомарные операции на кадр. Если писатель не успел начать снимок, кадр пропускается (dropped);
+// [RU] если он посреди снимка — прерывается через строку, и ждать приходится не дольше копии одной строки.
+// [EN] Buffers do not rotate through the render thread: it keeps drawing into one and the same hot frame. The writer
+// [EN] copies it into a packed snapshot in the gap before the next frame, then encodes and writes the snapshot. The
+// [EN] render thread pays two atomic operations per frame. If the writer has not started the snapshot, the frame is
+// [EN] skipped (dropped); if it is mid-snapshot, it aborts within a row, so the wait is at most one row's copy.
+struct Recorder{
+    int keyEvery=120;                          // [RU] Ключевой кадр раз в N записанных (и при ресайзе)
+                                               // [EN] A keyframe every N written frames (and on resize)
+    uint64_t submitted=0;                      // [RU] Пишет только поток рендера
+                                               // [EN] Written only by the render thread
+    std::atomic<uint64_t> dropped{0};          // [RU] Пропуски: поток рендера забрал кадр раньше снимка
+                                               // [EN] Drops: the render thread took the frame back before the snapshot
+    std::atomic<uint64_t> written{0}, bytes{0}; // [RU] Пишет только писатель
+                                                // [EN] Written only by the writer
+    std::atomic<bool> failed{false};           // [RU] Ошибка записи — дальше кадры только считаются
+                                               // [EN] A write error — from then on frames are only counted
+    Recorder(){}
+    Recorder(const Recorder&)=delete; Recorder&operator=(const Recorder&)=delete;
+    ~Recorder(){ close(); }
+
+    bool open(const char*path){
+        f=std::fopen(path,"wb"); if(!f) return false;
+        std::setvbuf(f,nullptr,_IOFBF,1<<20);  // [RU] Крупный буфер — мало системных вызовов
+                                               // [EN] A large buffer — few system calls
+        if(std::fwrite(recMagic,1,8,f)!=8){ std::fclose(f); f=nullptr; return false; }
+        stop.store(false); th=std::thread([this]{ loop(); });
+        return true;
+    }
+    bool isOpen()const{ return f!=nullptr; }
+
+    // [RU] Поток рендера: fr готов к записи. fr нельзя менять до reclaim() или flush().
+    // [EN] Render thread: fr is ready to be recorded. fr must not change until reclaim() or flush().
+    bool submit(const Frame&fr,uint64_t tNs){
+        const uint32_t seq=(uint32_t)submitted++;
+        if(!f) return false;
+        reclaim();                             // [RU] На случай, если вызывающий не забрал прошлый кадр
+                                               // [EN] In case the caller did not take the previous frame back
+        pending=&fr; pendingT=tNs; pendingSeq=seq;
+        state.store(Ready,std::memory_order_release);
+        return true;
+    }
+    // [RU] Поток рендера: забрать кадр перед тем, как рисовать в него (или менять размер). Не ждёт диск.
+    // [EN] Render thread: take the frame back before drawing into it (or resizing it). Never waits on disk.
+    void reclaim(){
+        int s=Ready;
+        if(state.compare_exchange_strong(s,Idle,std::memory_order_acquire)){ dropped.fetch_add(1,std::memory_order_relaxed); return; }
+        if(s==Idle) return;                    // [RU] Снимок уже готов — обычный случай
+                                               // [EN] The snapshot is already done — the usual case
+        s=Copying;
+        state.compare_exchange_strong(s,Abort,std::memory_order_acq_rel);
+        while(state.load(std::memory_order_acquire)!=Idle) std::this_thread::yield(); // [RU] Не дольше строки
+                                                                                       // [EN] At most one row
+    }
+    // [RU] Поток рендера: дождаться снимка последнего кадра, прежде чем кадр исчезнет (выход из программы)
+    // [EN] Render thread: wait for the last frame's snapshot before the frame goes away (program exit)
+    void flush(){ while(f&&state.load(std::memory_order_acquire)!=Idle) std::this_thread::yield(); }
+    void close(){                              // [RU] Дописывает последний снимок, закрывает файл
+                                               // [EN] Writes the last snapshot, closes the file
+        if(!f) return;
+        stop.store(true); th.join();
+        if(std::fclose(f)!=0) failed.store(true);
+        f=nullptr;
+    }
+    void print(FILE*o)const{
+        const uint64_t w=written.load(), b=bytes.load();
+        std::fprintf(o,"record: %llu frames written, %llu dropped, %llu bytes (%.0f B/frame)%s\n",(unsigned long long)w,(unsigned long long)dropped.load(),
+                     (unsigned long long)b,w?(double)b/(double)w:0.0,failed.load()?", WRITE ERROR":"");
+    }
+
+private:
+    enum{ Idle, Ready, Copying, Abort };       // [RU] Idle — кадр у рендера; Ready — опубликован; Copying — писатель снимает; Abort — рендер просит вернуть
+                                               // [EN] Idle — the frame is the renderer's; Ready — published; Copying — the writer snapshots; Abort — the renderer wants it back
+    alignas(64) std::atomic<int> state{Idle};
+    const Frame*pending=nullptr; uint64_t pendingT=0; uint32_t pendingSeq=0; // [RU] Пишет рендер до Ready, читает писатель после
+                                                                             // [EN] Set by the renderer before Ready, read by the writer after
+    std::atomic<bool> stop{false};
+    std::thread th;
+    FILE*f=nullptr;
+    std::vector<uint16_t> snap;                // [RU] Снимок кадра: упакованные ячейки
+                                               // [EN] Frame snapshot: packed cells
+    std::vector<uint16_t> prev;                // [RU] Последний записанный кадр — основа дельты
+                                               // [EN] Last written frame — the base of the delta
+    int sW=0, sH=0, pW=0, pH=0; uint64_t sinceKey=0;
+    std::vector<uint8_t> out;                  // [RU] Данные записи — переиспользуются
+                                               // [EN] Record payload — reused
+
+    void loop(){
+        for(;;){
+            int s=Ready;
+            if(!state.compare_exchange_strong(s,Copying,std::memory_order_acquire)){
+                if(stop.load()) return;        // [RU] Нового кадра нет и пора выходить
+                                               // [EN] No new frame and time to leave
+                std::this_thread::sleep_for(std::chrono::milliseconds(1)); continue;
+            }
+            const uint64_t t=pendingT; const uint32_t seq=pendingSeq;
+            const bool whole=copy(*pending);
+            s=Copying;
+            if(!state.compare_exchange_strong(s,Idle,std::memory_order_release)) state.store(Idle,std::memory_order_release); // [RU] Abort → кадр снова у рендера
+                                                                                                                              // [EN] Abort → the frame is the renderer's again
+            if(!whole){ dropped.fetch_add(1,std::memory_order_relaxed); continue; }
+            if(!failed.load(std::memory_order_relaxed)) encode(seq,t);
+        }
+    }
+    bool copy(const Frame&fr){                 // [RU] Построчно, с проверкой Abort между строками; false — прервано
+                                               // [EN] Row by row, checking for Abort between rows; false — aborted
+        sW=fr.W; sH=fr.H; snap.resize(fr.size()); // [RU] Аллокация только при росте кадра — в потоке писателя
+                                                  // [EN] Allocates only when the frame grows — on the writer thread
+        for(int y=0;y<sH;++y){
+            if(state.load(std::memory_order_relaxed)==Abort) return false;
+            const size_t row=(size_t)y*(size_t)sW;
+            for(int x=0;x<sW;++x) snap[row+(size_t)x]=packCell(fr.at(row+(size_t)x));
+        }
+        return true;
+    }
+    void encode(uint32_t seq,uint64_t t){
+        const size_t n=(size_t)sW*(size_t)sH; const uint16_t*c=snap.data();
+        const bool key = sW!=pW || sH!=pH || sinceKey%(uint64_t)keyEvery==0;
+        out.clear();
+        if(key){ prev.assign(c,c+n); pW=sW; pH=sH; sinceKey=0;
+            for(size_t i=0;i<n;){ const uint16_t v=c[i]; size_t j=i+1;
+                while(j<n&&c[j]==v) ++j;
+                putVarint(out,(uint32_t)(j-i)); out.push_back((uint8_t)(v&0xFF)); out.push_back((uint8_t)(v>>8));
+                i=j; }
+        } else {
+            for(size_t i=0;i<n;){ size_t j=i;
+                while(j<n&&c[j]==prev[j]) ++j; // [RU] Пропуск неизменных
+                                               // [EN] Skip unchanged cells
+                if(j==n) break;
+                const uint16_t v=c[j]; size_t k=j+1;
+                while(k<n&&c[k]==v) ++k;       // [RU] Серия одинаковых (даже если часть не менялась)
+                                               // [EN] A run of equal cells (even if some did not change)
+                putVarint(out,(uint32_t)(j-i)); putVarint(out,(uint32_t)(k-j)); out.push_back((uint8_t)(v&0xFF)); out.push_back((uint8_t)(v>>8));
+                for(size_t q=j;q<k;++q) prev[q]=v;
+                i=k; }
+        }
+        ++sinceKey;
+        uint8_t hdr[21]; const uint16_t w16=(uint16_t)sW, h16=(uint16_t)sH; const uint32_t len=(uint32_t)out.size();
+        hdr[0]=key?'K':'D'; std::memcpy(hdr+1,&seq,4); std::memcpy(hdr+5,&t,8); std::memcpy(hdr+13,&w16,2); std::memcpy(hdr+15,&h16,2); std::memcpy(hdr+17,&len,4);
+        if(std::fwrite(hdr,1,sizeof hdr,f)!=sizeof hdr||std::fwrite(out.data(),1,out.size(),f)!=out.size()){ failed.store(true); return; }
+        written.fetch_add(1,std::memory_order_relaxed); bytes.fetch_add(sizeof hdr+out.size(),std::memory_order_relaxed);
+    }
+};
+
+// [RU] --- Чтение записи: next() восстанавливает следующий кадр в cells ---
+// [EN] --- Reading a recording: next() restores the following frame into cells ---
+struct ReplayReader{
+    int W=0,H=0; uint32_t seq=0; uint64_t t=0; bool key=false;
+    std::vector<uint16_t> cells;               // [RU] Текущий кадр, упакованные ячейки
+                                               // [EN] The current frame, packed cells
+
+    ReplayReader(){}
+    ReplayReader(const ReplayReader&)=delete; ReplayReader&operator=(const ReplayReader&)=delete;
+    ~ReplayReader(){ if(f) std::fclose(f); }
+
+    bool open(const char*path,std::string&err){
+        f=std::fopen(path,"rb"); if(!f){ err=std::string("cannot open ")+path; return false; }
+        char m[8]; if(std::fread(m,1,8,f)!=8||std::memcmp(m,recMagic,8)){ err=std::string(path)+": not a cube recording"; return false; }
+        return true;
+    }
+    int next(std::string&err){                 // [RU] 1 — кадр готов, 0 — конец файла, -1 — ошибка
+                                               // [EN] 1 — a frame is ready, 0 — end of file, -1 — error
+        uint8_t hdr[21]; size_t got=std::fread(hdr,1,sizeof hdr,f);
+        if(got==0) return 0;
+        if(got!=sizeof hdr){ err="truncated record header"; return -1; }
+        uint16_t w16,h16; uint32_t len;
+        std::memcpy(&seq,hdr+1,4); std::memcpy(&t,hdr+5,8); std::memcpy(&w16,hdr+13,2); std::memcpy(&h16,hdr+15,2); std::memcpy(&len,hdr+17,4);
+        key=hdr[0]=='K';
+        if(!key&&hdr[0]!='D'){ err="unknown record type"; return -1; }
+        buf.resize(len); if(len&&std::fread(buf.data(),1,len,f)!=len){ err="truncated record"; return -1; }
+        if(key){ W=w16; H=h16; cells.assign((size_t)W*(size_t)H,packCell(Cell{' ',0})); }
+        else if(w16!=W||h16!=H||cells.empty()){ err="delta without a matching keyframe"; return -1; }
+        const uint8_t*p=buf.data(), *end=p+len; const size_t n=cells.size(); size_t i=0;
+        while(p<end){
+            uint32_t skip=0, run;
+            if(!key&&!getVarint(p,end,skip)){ err="corrupt delta"; return -1; }
+            if(!getVarint(p,end,run)||end-p<2||i+skip+run>n){ err="corrupt run"; return -1; }
+            i+=skip; const uint16_t v=(uint16_t)(p[0]|(p[1]<<8)); p+=2;
+            for(uint32_t k=0;k<run;++k) cells[i++]=v;
+        }
+        if(key&&i!=n){ err="short keyframe"; return -1; }
+        return 1;
+    }
+    void toFrame(Frame&fr)const{               // [RU] В Frame — для любой RenderTarget и для контрольной суммы
+                                               // [EN] Into a Frame — for any RenderTarget and for the checksum
+        if(fr.W!=W||fr.H!=H) fr.resize(W,H);
+        fr.clear(); for(size_t i=0;i<cells.size();++i) fr.set(i,unpackCell(cells[i]));
+    }
+private:
+    FILE*f=nullptr;
+    std::vector<uint8_t> buf;
+};
+
+// [RU] --- Экспорт в asciicast v2: по событию "o" на кадр с той же ANSI-дельтой, что идёт в терминал ---
+// [EN] --- asciicast v2 export: one "o" event per frame carrying the same ANSI delta a terminal receives ---
+static inline bool exportAsciicast(const char*inPath,const char*outPath,std::string&err){
+    ReplayReader rd; if(!rd.open(inPath,err)) return false;
+    FILE*o=std::fopen(outPath,"wb"); if(!o){ err=std::string("cannot create ")+outPath; return false; }
+    Frame fr; AnsiEncoder enc; std::string ansi, json; bool header=false; int r;
+    while((r=rd.next(err))==1){
+        if(!header){ std::fprintf(o,"{\"version\": 2, \"width\": %d, \"height\": %d, \"env\": {\"TERM\": \"xterm-256color\"}}\n",rd.W,rd.H); header=true; }
+        rd.toFrame(fr); ansi.clear(); enc.encode(fr,ansi);
+        json.clear();
+        for(char c:ansi){                      // [RU] JSON-экранирование: ESC и прочие управляющие — \u00XX
+                                               // [EN] JSON escaping: ESC and other control characters — \u00XX
+            if(c=='"'||c=='\\'){ json+='\\'; json+=c; }
+            else if((unsigned char)c<0x20){ char u[8]; std::snprintf(u,sizeof u,"\\u%04x",(unsigned)(unsigned char)c); json+=u; }
+            else json+=c;
+        }
+        std::fprintf(o,"[%.6f, \"o\", \"%s\"]\n",(double)rd.t/1e9,json.c_str());
+    }
+    if(std::fclose(o)!=0&&r>=0){ err=std::string("write error on ")+outPath; return false; }
+    return r==0;
+}
@@ -0,0 +1,318 @@
+// [RU] === render.h — переносимое ядро рендера: грани, z-буфер, затенение, цели вывода ===
+// [EN] === render.h — portable renderer core: faces, z-buffer, shading, render targets ===
+#pragma once
+#include <vector>                              // [RU] Плоские буферы под символы и глубину
+                                               // [EN] Flat buffers for characters and depth
+#include <string>                              // [RU] Палитра символов
+                                               // [EN] Character ramp
+#include <cstdint>                             // [RU] Фиксированные ширины для атрибутов и хешей
+                                               // [EN] Fixed widths for attributes and hashes
+#include <cmath>                               // [RU] Тригонометрия и корни
+                                               // [EN] Trigonometry and square roots
+#include <cstring>                             // [RU] memset — стирание кадра
+                                               // [EN] memset — wiping the frame
+#include "arena.h"                             // [RU] Выровненная память кадра без аллокаций в кадре
+                                               // [EN] Aligned frame memory with no per-frame allocations
+#include "trace.h"                             // [RU] Счётчики и стадии (только с -DCUBE_TRACE)
+                                               // [EN] Counters and stages (only with -DCUBE_TRACE)
+#include <algorithm>                           // [RU] clamp/fill — аккуратная работа с массивами
+                                               // [EN] clamp/fill — tidy array handling
+
+// [RU] --- Мини-алгебра 3D ---
+// [EN] --- Tiny 3D algebra ---
+struct Vec3{ float x,y,z; };                   // [RU] Компактный контейнер координат
+                                               // [EN] Compact coordinate container
+static inline Vec3 add(const Vec3&a,const Vec3&b){return {a.x+b.x,a.y+b.y,a.z+b.z};} // [RU] Сумма — для сдвига сцены
+                                                                                     // [EN] Sum — used for translating the scene
+static inline Vec3 mul(const Vec3&a,float s){return {a.x*s,a.y*s,a.z*s};}            // [RU] Масштаб — удобно для нормалей
+                                                                                     // [EN] Scale — handy for normals
+static inline Vec3 sub(const Vec3&a,const Vec3&b){return {a.x-b.x,a.y-b.y,a.z-b.z};} // [RU] Разность — рёбра треугольника
+                                                                                     // [EN] Difference — triangle edges
+static inline Vec3 cross(const Vec3&a,const Vec3&b){return {a.y*b.z-a.z*b.y,a.z*b.x-a.x*b.z,a.x*b.y-a.y*b.x};} // [RU] Векторное — нормаль грани
+                                                                                                              // [EN] Cross product — face normal
+static inline float dot(const Vec3&a,const Vec3&b){return a.x*b.x+a.y*b.y+a.z*b.z;}  // [RU] Скалярное — основа освещения
+                                                                                     // [EN] Dot product — basis for lighting
+static inline Vec3 norm(const Vec3&a){float m=std::sqrt(dot(a,a)+1e-9f);return {a.x/m,a.y/m,a.z/m};} // [RU] Нормализация с защитой
+                                                                                                     // [EN] Normalization with a safety guard
+
+// [RU] --- Повороты вокруг осей + композиция ---
+// [EN] --- Rotations around axes + composition ---
+static inline Vec3 rotX(const Vec3&p,float s,float c){return {p.x, c*p.y - s*p.z, s*p.y + c*p.z};}   // [RU] Вращение X
+                                                                                                     // [EN] Rotation around X
+static inline Vec3 rotY(const Vec3&p,float s,float c){return { c*p.x + s*p.z, p.y, -s*p.x + c*p.z};} // [RU] Вращение Y
+                                                                                                     // [EN] Rotation around Y
+static inline Vec3 rotZ(const Vec3&p,float s,float c){return { c*p.x - s*p.y, s*p.x + c*p.y, p.z};}  // [RU] Вращение Z
+                                                                                                     // [EN] Rotation around Z
+static inline Vec3 rotateAll(const Vec3&p,float sx,float cx,float sy,float cy,float sz,float cz){    // [RU] Композиция Z→X→Y
+                                                                                                     // [EN] Composition Z→X→Y
+    return rotY(rotX(rotZ(p,sz,cz),sx,cx),sy,cy);                                                     // [RU] Порядок выбран ради живой динамики
+                                                                                                      // [EN] Order chosen for lively motion
+}
+
+// [RU] --- Параметризация граней куба ---
+// [EN] --- Cube face parameterization ---
+struct Face{ Vec3 axis; float sign; };         // [RU] axis — какая координата фиксируется; sign — какая из двух сторон
+                                               // [EN] axis — which coordinate is fixed; sign — which of the two sides
+static const Face cubeFaces[6]={
+    {{1,0,0},+1}, {{1,0,0},-1},                // [RU] X=±1
+                                               // [EN] X=±1
+    {{0,1,0},+1}, {{0,1,0},-1},                // [RU] Y=±1
+                                               // [EN] Y=±1
+    {{0,0,1},+1}, {{0,0,1},-1},                // [RU] Z=±1
+                                               // [EN] Z=±1
+};
+static inline Vec3 pointOnFace(const Face&f,float u,float v){ // [RU] Генерация точки (u,v)∈[-1,1]² на выбранной грани
+                                                              // [EN] Generate point (u,v)∈[-1,1]² on the chosen face
+    if(f.axis.x) return { f.sign, u, v };       // [RU] На X-гранях фиксируем X
+                                                // [EN] On X-faces we fix X
+    if(f.axis.y) return { u, f.sign, v };       // [RU] На Y-гранях фиксируем Y
+                                                // [EN] On Y-faces we fix Y
+    return { u, v, f.sign };                    // [RU] На Z-гранях фиксируем Z
+                                                // [EN] On Z-faces we fix Z
+}
+
+// [RU] --- Цвета: те же биты, что FOREGROUND_* в WinAPI, но без <windows.h> ---
+// [EN] --- Colors: the same bits as WinAPI FOREGROUND_*, but without <windows.h> ---
+enum : uint16_t { ATTR_BLUE=0x1, ATTR_GREEN=0x2, ATTR_RED=0x4, ATTR_BRIGHT=0x8 };
+static const uint16_t faceColors[6] = {
+    ATTR_RED | ATTR_BRIGHT,                    // [RU] X+ красный
+                                               // [EN] X+ red
+    ATTR_GREEN | ATTR_BRIGHT,                  // [RU] X- зелёный
+                                               // [EN] X- green
+    ATTR_BLUE | ATTR_BRIGHT,                   // [RU] Y+ синий
+                                               // [EN] Y+ blue
+    ATTR_RED | ATTR_GREEN | ATTR_BRIGHT,       // [RU] Y- жёлтый
+                                               // [EN] Y- yellow
+    ATTR_RED | ATTR_BLUE | ATTR_BRIGHT,        // [RU] Z+ magenta
+                                               // [EN] Z+ magenta
+    ATTR_GREEN | ATTR_BLUE | ATTR_BRIGHT       // [RU] Z- cyan
+                                               // [EN] Z- cyan
+};
+
+// [RU] --- Геометрия цели вывода и форма символа ---
+// [EN] --- Render target geometry and character shape ---
+struct Geom{ int W,H; float charAspect; };     // [RU] Размер в символах и height/width глифа
+                                               // [EN] Size in characters and glyph height/width
+
+// [RU] --- Проектор с учётом реального aspect символа ---
+// [EN] --- Projector accounting for the real character aspect ratio ---
+struct Projector{ int W,H; float fx,fy;        // [RU] W/H — символы; fx/fy — фокальные масштабы по осям
+                                               // [EN] W/H — characters; fx/fy — focal scales along axes
+    explicit Projector(const Geom&g){ W=g.W; H=g.H; fx=W*0.60f; fy=fx/g.charAspect; } // [RU] Баланс ширины/высоты
+                                                                                      // [EN] Balance width/height
+    bool toScreen(const Vec3&p,int&sx,int&sy)const{ if(p.z<=0.001f) return false; float invz=1.0f/p.z; // [RU] Стабильная перспектива
+                                                                                                       // [EN] Stable perspective
+        float x=p.x*invz, y=p.y*invz; sx=(int)(x*fx+W*0.5f); sy=(int)(-y*fy+H*0.5f);                 // [RU] Центрируем и масштабируем
+                                                                                                     // [EN] Center and scale
+        return (unsigned)sx<(unsigned)W && (unsigned)sy<(unsigned)H; }                                // [RU] Быстрая проверка границ
+                                                                                                      // [EN] Fast bounds check
+    void toScreenF(const Vec3&p,float&X,float&Y)const{ float invz=1.0f/p.z; // [RU] Непрерывные координаты, без отсечения (p.z>0)
+                                                                            // [EN] Continuous coordinates, no clipping (p.z>0)
+        X=p.x*invz*fx+W*0.5f; Y=-p.y*invz*fy+H*0.5f; }
+};
+
+// [RU] --- Кадр: символ+цвет и обратная глубина на каждую ячейку ---
+// [EN] --- Frame: character+color and inverse depth per cell ---
+struct Cell{ char ch; uint16_t attr; };        // [RU] Переносимый аналог CHAR_INFO
+                                               // [EN] Portable counterpart of CHAR_INFO
+
+// [RU] Глубина, поколение, символ и цвет лежат рядом: z-тест и запись трогают одни 8 байт одной строки кеша.
+// [RU] attr хранится байтом цвета консоли (FOREGROUND_*/BACKGROUND_*); флаги COMMON_LVB_* не используются.
+// [EN] Depth, generation, character and color sit together: the z-test and the write touch the same 8 bytes of one cache line.
+// [EN] attr is stored as the console color byte (FOREGROUND_*/BACKGROUND_*); COMMON_LVB_* flags are not used.
+struct FrameCell{ float z; uint16_t gen; char ch; uint8_t attr; };
+static_assert(sizeof(FrameCell)==8,"FrameCell must stay 8 bytes");
+
+// [RU] Очистки нет: кадр увеличивает поколение, ячейка чужого поколения считается пустой (' ', 0, z=-∞).
+// [RU] Настоящее стирание — только при ресайзе и раз в 65535 кадров, когда счётчик переполняется.
+// [EN] There is no clear: the frame bumps its generation, and a cell of another generation counts as empty (' ', 0, z=-∞).
+// [EN] A real wipe happens only on resize and once every 65535 frames, when the counter wraps.
+struct Frame{ int W=0,H=0;
+    FrameCell*cells=nullptr;                   // [RU] W·H ячеек в арене, выровнено по строке кеша
+                                               // [EN] W·H cells in the arena, cache-line aligned
+    uint16_t gen=1;                            // [RU] Текущее поколение; 0 не выдаётся — это «никогда не писали»
+                                               // [EN] Current generation; 0 is never issued — it means "never written"
+    Arena arena;                               // [RU] Растёт только при увеличении окна
+                                               // [EN] Grows only when the window gets bigger
+
+    size_t size()const{ return (size_t)W*(size_t)H; }
+    void resize(int w,int h){ W=w; H=h; arena.reset(); cells=arena.alloc<FrameCell>(size()); wipe(); } // [RU] Ресайз = очистка
+                                                                                                        // [EN] Resize implies a clear
+    void clear(){ TRACE_SCOPE(TS_CLEAR,-1); if(++gen==0) wipe(); } // [RU] O(1) вместо прохода по всему кадру
+                                                                   // [EN] O(1) instead of a pass over the whole frame
+    Cell at(size_t i)const{ const FrameCell&c=cells[i]; return c.gen==gen ? Cell{c.ch,c.attr} : Cell{' ',0}; }
+    void set(size_t i,Cell c){ cells[i]=FrameCell{0.0f,gen,c.ch,(uint8_t)c.attr}; } // [RU] Без z-теста — для воспроизведения записи
+                                                                                     // [EN] No z-test — for replaying a recording
+    void swap(Frame&o){ std::swap(W,o.W); std::swap(H,o.H); std::swap(cells,o.cells); std::swap(gen,o.gen); arena.swap(o.arena); } // [RU] O(1): обмен буферами
+                                                                                                                                   // [EN] O(1): buffers change hands
+    void plot(size_t i,float w,Cell c){        // [RU] Z-тест и запись: пустая ячейка принимает всё
+                                               // [EN] Z-test and write: an empty cell accepts anything
+        FrameCell&p=cells[i];
+        TRACE_COUNT(p.gen!=gen ? TC_WRITTEN : w>p.z ? TC_OVERDRAW : TC_ZREJECT,1);
+        if(p.gen!=gen||w>p.z) p=FrameCell{w,gen,c.ch,(uint8_t)c.attr};
+    }
+private:
+    void wipe(){ if(size()) std::memset((void*)cells,0,size()*sizeof(FrameCell)); gen=1; }
+};
+
+// [RU] --- Способ заливки граней ---
+// [EN] --- How faces are filled ---
+enum class RasterMode{
+    Sampler,                                   // [RU] Параметрическая сетка (u,v) с шагом step — исходный способ
+                                               // [EN] Parametric (u,v) grid with a fixed step — the original method
+    Scanline,                                  // [RU] Проекция 4 углов + построчная заливка, работа ~ площади на экране
+                                               // [EN] Project 4 corners + scanline fill, work ~ covered screen area
+    Batch,                                     // [RU] Та же сетка, что у сэмплера, но SoA + SIMD-ядро (simd.h)
+                                               // [EN] The sampler's grid, but SoA + a SIMD kernel (simd.h)
+    Tiled,                                     // [RU] Scanline по тайлам в пуле потоков (tiles.h), кадр побитно как Scanline
+                                               // [EN] Scanline over tiles on a thread pool (tiles.h), bit-identical to Scanline
+};
+
+static constexpr float defaultSampleStep=0.032f; // [RU] Шаг сетки по умолчанию — под него ось сэмплера строится при компиляции
+                                                 // [EN] Default grid step — the sampler axis is built for it at compile time
+
+// [RU] --- Параметры сцены: всё, что раньше было константами main() ---
+// [EN] --- Scene parameters: everything that used to be main() constants ---
+struct RenderParams{
+    std::string ramp = " .,:;ox%#@";           // [RU] Мягкая палитра без «полосатых» символов
+                                               // [EN] Soft palette without "stripy" characters
+    Vec3 lightDir = norm({-0.5f,1.0f,1.2f});   // [RU] Свет от верх-лево-вперёд — красивый рельеф
+                                               // [EN] Light from up-left-forward — pleasing relief
+    float ambient   = 0.25f;                   // [RU] Базовая подсветка чуть ярче для контраста
+                                               // [EN] Base ambient slightly brighter for contrast
+    float camZ      = 3.2f;                    // [RU] Двигаем сцену вперёд — камера в (0,0,0), смотрит вдоль +Z
+                                               // [EN] Push the scene forward — camera at (0,0,0), looking along +Z
+    float nearZ     = 0.25f;                   // [RU] Ближняя плоскость — не даём проходить через камеру
+                                               // [EN] Near plane — prevent passing through the camera
+    float step      = defaultSampleStep;       // [RU] Шаг параметрической сетки по граням — плотность/скорость
+                                               // [EN] Parametric grid step on faces — density/speed
+    float cubeScale = 1.0f;                    // [RU] Масштаб куба (изменяется на + и -)
+                                               // [EN] Cube scale (adjust with + and -)
+    RasterMode mode = RasterMode::Tiled;       // [RU] Растеризатор граней (сэмплер — для сравнения)
+                                               // [EN] Face rasterizer (the sampler is kept for comparison)
+};
+
+// [RU] --- Поза: предрасчитанная тригонометрия трёх углов ---
+// [EN] --- Pose: precomputed trigonometry of the three angles ---
+struct Pose{ float sx,cx,sy,cy,sz,cz;
+    static Pose at(float t,float rotSpeed){    // [RU] Независимые фазы — приятная динамика
+                                               // [EN] Independent phases — pleasant dynamics
+        float ax=t*0.9f*rotSpeed, ay=t*0.7f*rotSpeed+1.3f, az=t*1.1f*rotSpeed+0.7f;
+        return {std::sin(ax),std::cos(ax), std::sin(ay),std::cos(ay), std::sin(az),std::cos(az)};
+    }
+};
+
+// [RU] --- Свет по нормали в координатах камеры: BACK-FACE CULLING + ambient + diffuse; false — не рисуем ---
+// [EN] --- Lighting from a camera-space normal: BACK-FACE CULLING + ambient + diffuse; false — not drawn ---
+static inline bool litNormal(const Vec3&nCam,const RenderParams&rp,float&shadeF){ // [RU] Общий для граней куба и треугольников мешей
+                                                                                  // [EN] Shared by cube faces and mesh triangles
+    if(nCam.z >= 0.0f) return false;           // [RU] Грань от камеры — не рисуем её вовсе
+                                               // [EN] Face turned away from the camera — skip drawing entirely
+    float lambert = std::max(0.0f, dot(nCam, rp.lightDir)); // [RU] Диффузная составляющая света
+                                                            // [EN] Diffuse light component
+    shadeF  = std::clamp(rp.ambient + (1.0f-rp.ambient)*lambert, 0.0f, 1.0f); // [RU] Ambient + diffuse
+                                                                               // [EN] Ambient + diffuse
+    return true;
+}
+
+// [RU] --- Свет грани куба: нормаль грани + чередование яркости ---
+// [EN] --- Cube face lighting: face normal + alternating brightness ---
+static inline bool litFace(int faceIndex,const Pose&ps,const RenderParams&rp,float&shadeF){
+    const Face& f = cubeFaces[faceIndex];
+    Vec3 nCam = rotateAll(mul(norm(f.axis),f.sign), ps.sx,ps.cx,ps.sy,ps.cy,ps.sz,ps.cz); // [RU] Нормаль грани в координатах камеры
+                                                                                          // [EN] Face normal in camera coordinates
+    if(!litNormal(nCam,rp,shadeF)) return false;
+    shadeF *= (0.8f + 0.4f * (faceIndex % 2)); // [RU] Per-face контраст: чередование яркости
+                                               // [EN] Per-face contrast: alternating brightness
+    return true;
+}
+static inline char shadeGlyph(const RenderParams&rp,float shadeF){ // [RU] Яркость → символ палитры
+                                                                   // [EN] Brightness → ramp character
+    const int rampMax=(int)rp.ramp.size()-1;
+    return rp.ramp[(size_t)std::clamp((int)std::round(shadeF*rampMax),0,rampMax)];
+}
+
+// [RU] --- Рендер куба в кадр: фронт-face-culling + ambient + цвета + окклюзия ---
+// [EN] --- Render the cube into a frame: front-face culling + ambient + colors + occlusion ---
+// [RU] Исходный обобщённый цикл; рендерер рисует через TableSampler (sampler.h), а этот — эталон для бенчмарка.
+// [EN] The original generic loop; the renderer draws through TableSampler (sampler.h), and this one is the benchmark reference.
+static inline void renderCube(Frame&fr,const Projector&proj,const RenderParams&rp,const Pose&ps){
+    fr.clear();                                // [RU] Чистый лист на каждый кадр
+                                               // [EN] Clean slate every frame
+    const float sx=ps.sx,cx=ps.cx,sy=ps.sy,cy=ps.cy,sz=ps.sz,cz=ps.cz;
+    const int rampMax=(int)rp.ramp.size()-1;
+    for(int faceIndex=0; faceIndex<6; ++faceIndex){ // [RU] По всем шести граням с индексом
+                                                    // [EN] Iterate over all six faces by index
+        const Face& f = cubeFaces[faceIndex];
+        float shadeF; if(!litFace(faceIndex,ps,rp,shadeF)) continue; // [RU] Отсечение задних граней + свет
+                                                                     // [EN] Back-face culling + lighting
+        TRACE_SCOPE(TS_FACE,faceIndex);
+
+        // [RU] Полуоткрытые интервалы для избежания дубликатов на ребрах
+        // [EN] Half-open intervals to avoid duplicates on edges
+        for(float u=-1.0f; u < 1.0f + rp.step/2; u+=rp.step){
+            for(float v=-1.0f; v < 1.0f + rp.step/2; v+=rp.step){
+                TRACE_COUNT(TC_SAMPLES,1);
+                Vec3 rawP = mul(pointOnFace(f,u,v), rp.cubeScale); // [RU] Масштабируем точку грани
+                                                                   // [EN] Scale the face point
+                Vec3 p = rotateAll(rawP, sx,cx,sy,cy,sz,cz);      // [RU] Поворачиваем
+                                                                  // [EN] Rotate it
+                p = add(p,{0,0,rp.camZ});                         // [RU] Отодвигаем сцену от камеры
+                                                                  // [EN] Move the scene away from the camera
+                if(p.z<=rp.nearZ){ TRACE_COUNT(TC_NEAR,1); continue; } // [RU] Отсекаем «слишком близко» — без артефактов у стекла
+                                                                  // [EN] Clip "too close" — avoids artifacts at the near plane
+
+                int sxp,syp; if(!proj.toScreen(p,sxp,syp)){ TRACE_COUNT(TC_SCREEN,1); continue; } // [RU] Проекция и отсечение по экрану
+                                                                     // [EN] Projection and screen clipping
+
+                float invz = 1.0f/p.z + 1e-5f * (float)faceIndex; // [RU] Обратная глубина + bias для стабильности на ребрах
+                                                                  // [EN] Inverse depth + bias for stability along edges
+                size_t idx=(size_t)syp*(size_t)fr.W+(size_t)sxp;  // [RU] Индекс ячейки в кадре
+                                                                  // [EN] Cell index within the frame
+                int shade=(int)std::round(shadeF*rampMax);        // [RU] Индекс символа по яркости
+                                                                  // [EN] Character index by brightness
+                shade=std::clamp(shade,0,rampMax);                // [RU] Защита от округления
+                                                                  // [EN] Guard against rounding
+                fr.plot(idx,invz,Cell{ rp.ramp[(size_t)shade], faceColors[faceIndex] }); // [RU] Z-тест — пишем только ближнее
+                                                                                         // [EN] Z-test — write only the nearer
+            }
+        }
+    }
+}
+
+// [RU] --- Контрольная сумма кадра (FNV-1a) — доказательство, что ускорение не меняет картинку ---
+// [EN] --- Frame checksum (FNV-1a) — proof that a speedup does not change the picture ---
+static inline uint64_t frameChecksum(const Frame&fr,uint64_t h=1469598103934665603ull){
+    for(size_t i=0;i<fr.size();++i){ const Cell c=fr.at(i); // [RU] Только видимое: символ и атрибут
+                                                            // [EN] Only what is visible: character and attribute
+        h=(h^(uint8_t)c.ch)*1099511628211ull;
+        h=(h^(uint8_t)(c.attr&0xFF))*1099511628211ull;
+        h=(h^(uint8_t)(c.attr>>8))*1099511628211ull;
+    }
+    return h;
+}
+
+// [RU] --- Цель вывода: откуда берём размер и куда отдаём готовый кадр ---
+// [EN] --- Render target: where the size comes from and where a finished frame goes ---
+struct RenderTarget{
+    virtual ~RenderTarget(){}
+    virtual Geom geom()=0;                     // [RU] Актуальная геометрия (может меняться между кадрами)
+                                               // [EN] Current geometry (may change between frames)
+    virtual void present(const Frame&fr)=0;    // [RU] Показать кадр
+                                               // [EN] Show a frame
+};
+
+// [RU] --- Headless-цель: кадр в памяти произвольного WxH — для бенчмарка и тестов без консоли ---
+// [EN] --- Headless target: in-memory frame of arbitrary WxH — for benchmarks and console-free runs ---
+struct HeadlessTarget : RenderTarget{
+    Geom g;                                    // [RU] Фиксированный размер
+                                               // [EN] Fixed size
+    std::vector<Cell> last;                    // [RU] Копия последнего показанного кадра
+                                               // [EN] Copy of the last presented frame
+    uint64_t presented=0;                      // [RU] Счётчик кадров
+                                               // [EN] Frame counter
+    HeadlessTarget(int W,int H,float charAspect=2.0f):g{W,H,charAspect}{}
+    Geom geom() override { return g; }
+    void present(const Frame&fr) override { last.resize(fr.size()); for(size_t i=0;i<last.size();++i) last[i]=fr.at(i); ++presented; } // [RU] Без реаллокаций при том же размере
+                                                                                                                                        // [EN] No reallocation at a fixed size
+};
@@ -0,0 +1,114 @@
+// [RU] === sampler.h — сэмплер граней на готовых таблицах: сетка (u,v) и символы затенения считаются заранее ===
+// [EN] === sampler.h — face sampler on precomputed tables: the (u,v) grid and shade glyphs are built ahead of time ===
+#pragma once
+#include "render.h"                            // [RU] Грани, поворот, Projector, Frame, исходный renderCube
+                                               // [EN] Faces, rotation, Projector, Frame, the original renderCube
+#include <vector>
+
+// [RU] --- Ось сетки: те же значения u, что даёт цикл сэмплера u=-1; u<1+step/2; u+=step ---
+// [EN] --- Grid axis: the very u values the sampler loop u=-1; u<1+step/2; u+=step produces ---
+// [RU] Сетка грани — произведение оси на саму себя, поэтому хранится одна ось на все шесть граней:
+// [RU] 63 float при шаге по умолчанию вместо 6×63² точек, и она целиком живёт в L1.
+// [EN] A face grid is the axis times itself, so one axis is stored for all six faces:
+// [EN] 63 floats at the default step instead of 6×63² points, and it lives entirely in L1.
+constexpr int sampleAxisCount(float step){ int n=0; for(float u=-1.0f; u < 1.0f + step/2; u+=step) ++n; return n; }
+template<int N> struct SampleAxis{ float u[N]; };
+template<int N> constexpr SampleAxis<N> makeSampleAxis(float step){
+    SampleAxis<N> a{}; int i=0;
+    for(float u=-1.0f; u < 1.0f + step/2; u+=step) a.u[i++]=u;
+    return a;
+}
+static constexpr int defaultAxisCount=sampleAxisCount(defaultSampleStep);
+static constexpr SampleAxis<defaultAxisCount> defaultAxis=makeSampleAxis<defaultAxisCount>(defaultSampleStep); // [RU] Шаг по умолчанию — на этапе компиляции
+                                                                                                               // [EN] The default step — at compile time
+
+// [RU] --- Затенение → ячейка: символ и цвет на каждую пару (грань, индекс палитры), перестройка — только при смене палитры ---
+// [EN] --- Shade → cell: glyph and color for every (face, ramp index) pair, rebuilt only when the ramp changes ---
+struct ShadeLut{
+    std::string ramp;                          // [RU] Палитра, под которую построена таблица
+                                               // [EN] Ramp the table was built for
+    std::vector<Cell> cells;                   // [RU] cells[face*ramp.size()+k] = {ramp[k], faceColors[face]}
+                                               // [EN] cells[face*ramp.size()+k] = {ramp[k], faceColors[face]}
+    void update(const std::string&r){
+        if(r==ramp&&!cells.empty()) return;
+        ramp=r; cells.resize(6*ramp.size());
+        for(int f=0;f<6;++f) for(size_t k=0;k<ramp.size();++k) cells[(size_t)f*ramp.size()+k]=Cell{ramp[k],faceColors[f]};
+    }
+    Cell at(int face,float shadeF)const{       // [RU] Та же формула индекса, что у shadeGlyph, — раз на грань, а не на ячейку
+                                               // [EN] The same index formula as shadeGlyph — once per face, not per cell
+        const int rampMax=(int)ramp.size()-1;
+        return cells[(size_t)face*ramp.size()+(size_t)std::clamp((int)std::round(shadeF*rampMax),0,rampMax)];
+    }
+};
+
+// [RU] Точка грани для фиксированной оси: ветвления pointOnFace исчезают при компиляции
+// [EN] A face point for a fixed axis: pointOnFace's branches vanish at compile time
+template<int AXIS> static inline Vec3 facePoint(float s,float u,float v){
+    if constexpr(AXIS==0) return {s,u,v};
+    else if constexpr(AXIS==1) return {u,s,v};
+    else return {u,v,s};
+}
+
+// [RU] --- Ядро одной грани: на точку остаются поворот, проекция и z-тест ---
+// [EN] --- One face's kernel: per point only rotation, projection and the z-test remain ---
+// [RU] Операции и их порядок — как в renderCube, поэтому кадр побитно тот же. Масштаб умножается на ось один раз
+// [RU] на кадр, а слагаемые поворота, зависящие только от u, компилятор выносит из внутреннего цикла.
+// [EN] Operations and their order match renderCube, so the frame is bit-identical. The scale multiplies the axis once
+// [EN] per frame, and the rotation terms that depend on u alone are hoisted out of the inner loop by the compiler.
+template<int AXIS>
+static void sampleFace(Frame&fr,const Projector&proj,const RenderParams&rp,const Pose&ps,const float*axis,int n,float s,float bias,Cell c){
+    const float sx=ps.sx,cx=ps.cx,sy=ps.sy,cy=ps.cy,sz=ps.sz,cz=ps.cz, camZ=rp.camZ, nearZ=rp.nearZ;
+    const size_t W=(size_t)fr.W;
+    for(int i=0;i<n;++i){ const float u=axis[i];
+        for(int j=0;j<n;++j){
+            Vec3 p=rotateAll(facePoint<AXIS>(s,u,axis[j]), sx,cx,sy,cy,sz,cz);
+            p=add(p,{0,0,camZ});
+            if(p.z<=nearZ){ TRACE_COUNT(TC_NEAR,1); continue; }
+            int sxp,syp; if(!proj.toScreen(p,sxp,syp)){ TRACE_COUNT(TC_SCREEN,1); continue; }
+            fr.plot((size_t)syp*W+(size_t)sxp,1.0f/p.z+bias,c);
+        }
+    }
+}
+
+// [RU] --- Сэмплер на таблицах: режим Sampler рендерера; renderCube остаётся эталоном для бенчмарка ---
+// [EN] --- Table-driven sampler: the renderer's Sampler mode; renderCube stays as the benchmark reference ---
+struct TableSampler{
+    float cachedStep=0.0f;                     // [RU] Шаг, под который построена axisCache
+                                               // [EN] Step axisCache was built for
+    std::vector<float> axisCache;              // [RU] Ось для шага, отличного от шага по умолчанию
+                                               // [EN] The axis for a step other than the default
+    std::vector<float> scaled;                 // [RU] Ось × cubeScale текущего кадра
+                                               // [EN] The axis × the current frame's cubeScale
+    ShadeLut lut;
+    uint64_t samples=0;                        // [RU] Точек отдано ядрам — для ns/точку в бенчмарке
+                                               // [EN] Points fed to the kernels — for ns/point in the benchmark
+
+    void axis(float step,const float*&a,int&n){ // [RU] Таблица компиляции или кеш, перестраиваемый только при смене шага
+                                                // [EN] The compile-time table or a cache rebuilt only when the step changes
+        if(step==defaultSampleStep){ a=defaultAxis.u; n=defaultAxisCount; return; }
+        if(step!=cachedStep){ cachedStep=step; axisCache.clear(); for(float u=-1.0f; u < 1.0f + step/2; u+=step) axisCache.push_back(u); }
+        a=axisCache.data(); n=(int)axisCache.size();
+    }
+
+    void render(Frame&fr,const Projector&proj,const RenderParams&rp,const Pose&ps){
+        fr.clear();
+        const float*a; int n; axis(rp.step,a,n);
+        if(scaled.size()!=(size_t)n) scaled.resize((size_t)n);
+        for(int i=0;i<n;++i) scaled[(size_t)i]=a[i]*rp.cubeScale; // [RU] То же произведение, что mul(pointOnFace(…),cubeScale)
+                                                                  // [EN] The same product as mul(pointOnFace(…),cubeScale)
+        lut.update(rp.ramp);
+        for(int faceIndex=0; faceIndex<6; ++faceIndex){
+            float shadeF; if(!litFace(faceIndex,ps,rp,shadeF)) continue; // [RU] Отсечение задних граней + свет
+                                                                         // [EN] Back-face culling + lighting
+            TRACE_SCOPE(TS_FACE,faceIndex);
+            TRACE_COUNT(TC_SAMPLES,(uint64_t)n*(uint64_t)n);
+            const Face&f=cubeFaces[faceIndex];
+            const float s=f.sign*rp.cubeScale, bias=1e-5f*(float)faceIndex;
+            const Cell c=lut.at(faceIndex,shadeF);
+            samples+=(uint64_t)n*(uint64_t)n;
+            if(f.axis.x)      sampleFace<0>(fr,proj,rp,ps,scaled.data(),n,s,bias,c); // [RU] Выбор ядра — раз на грань
+            else if(f.axis.y) sampleFace<1>(fr,proj,rp,ps,scaled.data(),n,s,bias,c); // [EN] Kernel choice — once per face
+            else              sampleFace<2>(fr,proj,rp,ps,scaled.data(),n,s,bias,c);
+        }
+    }
+};
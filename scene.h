@@ -0,0 +1,95 @@
+// [RU] === scene.h — сцена из многих экземпляров мешей: у каждого своё положение, масштаб, фаза вращения и цвет ===
+// [EN] === scene.h — a scene of many mesh instances: each with its own position, scale, rotation phase and color ===
+#pragma once
+#include "mesh.h"                              // [RU] Mesh с индексами и нормалями граней
+                                               // [EN] Mesh with indices and face normals
+#include "raster.h"                            // [RU] clipNear, Prim, setupPrim
+                                               // [EN] clipNear, Prim, setupPrim
+#include "simd.h"                              // [RU] Xform — поворот·масштаб одной матрицей
+                                               // [EN] Xform — rotation·scale as one matrix
+#include <vector>
+
+// [RU] --- Экземпляр: ссылка на общий меш + собственное преобразование ---
+// [EN] --- Instance: a reference to a shared mesh + its own transform ---
+struct Instance{
+    const Mesh*mesh;
+    Vec3 pos;                                  // [RU] Сдвиг центра относительно центра сцены
+                                               // [EN] Center offset from the scene center
+    float scale;                               // [RU] Масштаб меша (меш уже вписан в [-1,1]³)
+                                               // [EN] Mesh scale (the mesh is already fitted to [-1,1]³)
+    float phase;                               // [RU] Сдвиг времени для Pose::at — экземпляры крутятся вразнобой
+                                               // [EN] Time offset for Pose::at — instances spin out of step
+    uint16_t attr;                             // [RU] Цвет всех треугольников экземпляра
+                                               // [EN] Color of all of the instance's triangles
+};
+
+struct Scene{
+    std::vector<Instance> items;
+    size_t tris()const{ size_t n=0; for(const Instance&it:items) n+=it.mesh->tris(); return n; }
+
+    // [RU] n экземпляров сеткой k×k, вписанной в тот же объём, что и один куб; меши и цвета чередуются.
+    // [RU] Экземпляров не меньше, чем мешей, — каждая модель попадает в сцену хотя бы раз.
+    // [EN] n instances on a k×k grid fitted into the same volume as a single cube; meshes and colors alternate.
+    // [EN] There are at least as many instances as meshes — every model reaches the scene at least once.
+    void grid(const std::vector<const Mesh*>&meshes,int n){
+        items.clear(); if(meshes.empty()) return;
+        n=std::max(n,(int)meshes.size());
+        int k=1; while(k*k<n) ++k;
+        const float cellSz=2.0f/(float)k;      // [RU] Ширина клетки сетки
+                                               // [EN] Grid cell width
+        for(int i=0;i<n;++i){
+            const int gx=i%k, gy=i/k;
+            items.push_back({meshes[(size_t)i%meshes.size()], {((float)gx+0.5f)*cellSz-1.0f, 1.0f-((float)gy+0.5f)*cellSz, 0.0f},
+                             cellSz*0.5f, (float)i*0.37f, faceColors[i%6]});
+        }
+    }
+};
+
+// [RU] --- Подготовка примитивов сцены: вершины преобразуются один раз на экземпляр, треугольники — через общий путь куба ---
+// [EN] --- Scene primitive setup: vertices are transformed once per instance, triangles go through the cube's shared path ---
+// [RU] Отсечение задних граней и свет — тот же litNormal (nCam.z>=0, ambient + lambert), заливка и z-буфер — fillPrim.
+// [EN] Back-face culling and lighting are the same litNormal (nCam.z>=0, ambient + lambert); filling and z-buffer are fillPrim.
+struct MeshRaster{
+    std::vector<Vec3> cam;                     // [RU] Вершины текущего экземпляра в координатах камеры
+                                               // [EN] Current instance's vertices in camera space
+    std::vector<ScreenVert> scr;               // [RU] Их проекции (действительны при z>nearZ)
+                                               // [EN] Their projections (valid when z>nearZ)
+    uint64_t submitted=0, culled=0, emitted=0; // [RU] Треугольников на входе / отброшено задних / примитивов на выходе
+                                               // [EN] Triangles in / back faces culled / primitives out
+
+    void build(std::vector<Prim>&out,const Projector&proj,const RenderParams&rp,const Scene&sc,float t,float rotSpeed){
+        TRACE_SCOPE(TS_SETUP,-1);
+        out.clear();
+        for(const Instance&it:sc.items){
+            const Mesh&m=*it.mesh; const Pose ps=Pose::at(t+it.phase,rotSpeed);
+            const Xform x=makeXform(ps,it.scale*rp.cubeScale,rp.camZ); // [RU] Масштаб +/- действует на всю сцену
+                                                                       // [EN] The +/- scale applies to the whole scene
+            const Xform r=makeXform(ps,1.0f,0.0f);                     // [RU] Только поворот — для нормалей
+                                                                       // [EN] Rotation only — for normals
+            const Vec3 off=mul(it.pos,rp.cubeScale);
+            const size_t nv=m.pos.size(); cam.resize(nv); scr.resize(nv);
+            for(size_t i=0;i<nv;++i){ const Vec3&p=m.pos[i];
+                Vec3 c={x.m[0]*p.x+x.m[1]*p.y+x.m[2]*p.z+off.x, x.m[3]*p.x+x.m[4]*p.y+x.m[5]*p.z+off.y, x.m[6]*p.x+x.m[7]*p.y+x.m[8]*p.z+x.tz+off.z};
+                cam[i]=c;
+                if(c.z>rp.nearZ){ proj.toScreenF(c,scr[i].X,scr[i].Y); scr[i].w=1.0f/c.z; }
+            }
+            const size_t nt=m.tris(); submitted+=nt;
+            Prim pr;
+            for(size_t tri=0;tri<nt;++tri){
+                const Vec3&n=m.faceN[tri];
+                const Vec3 nc={r.m[0]*n.x+r.m[1]*n.y+r.m[2]*n.z, r.m[3]*n.x+r.m[4]*n.y+r.m[5]*n.z, r.m[6]*n.x+r.m[7]*n.y+r.m[8]*n.z};
+                float shadeF; if(!litNormal(nc,rp,shadeF)){ ++culled; continue; }
+                const uint32_t*ix=&m.idx[tri*3];
+                ScreenVert sv[8]; int nsv=3;
+                if(cam[ix[0]].z>rp.nearZ&&cam[ix[1]].z>rp.nearZ&&cam[ix[2]].z>rp.nearZ){ sv[0]=scr[ix[0]]; sv[1]=scr[ix[1]]; sv[2]=scr[ix[2]]; }
+                else {                         // [RU] Пересекает ближнюю плоскость — редкий медленный путь
+                                               // [EN] Crosses the near plane — the rare slow path
+                    const Vec3 q[3]={cam[ix[0]],cam[ix[1]],cam[ix[2]]}; Vec3 cl[8];
+                    nsv=clipNear(q,3,rp.nearZ,cl); if(nsv<3) continue;
+                    for(int k=0;k<nsv;++k){ proj.toScreenF(cl[k],sv[k].X,sv[k].Y); sv[k].w=1.0f/cl[k].z; }
+                }
+                if(setupPrim(pr,sv,nsv,Cell{shadeGlyph(rp,shadeF),it.attr},0.0f,proj.W,proj.H)){ out.push_back(pr); ++emitted; }
+            }
+        }
+    }
+};
@@ -0,0 +1,194 @@
+// [RU] === simd.h — пакетное преобразование и проекция точек в SoA: scalar / SSE2 / AVX2 ===
+// [EN] === simd.h — batch transform and projection of SoA points: scalar / SSE2 / AVX2 ===
+#pragma once
+#include "render.h"                            // [RU] Pose, Projector, RenderParams, грани
+                                               // [EN] Pose, Projector, RenderParams, faces
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#if (defined(__x86_64__)||defined(__i386__)) && (defined(__GNUC__)||defined(__clang__))
+#define CUBE_X86_SIMD 1                        // [RU] target-атрибуты GCC/Clang: один бинарник, выбор ISA в рантайме
+                                               // [EN] GCC/Clang target attributes: one binary, ISA picked at run time
+#include <immintrin.h>
+#endif
+
+// [RU] --- Набор инструкций ядра ---
+// [EN] --- Kernel instruction set ---
+enum class Isa{ Scalar, SSE2, AVX2 };
+static inline const char* isaName(Isa i){ return i==Isa::AVX2 ? "avx2" : i==Isa::SSE2 ? "sse2" : "scalar"; }
+static inline bool isaSupported(Isa i){        // [RU] Что умеет текущий процессор
+                                               // [EN] What the current CPU can do
+#ifdef CUBE_X86_SIMD
+    if(i==Isa::AVX2) return __builtin_cpu_supports("avx2");
+    if(i==Isa::SSE2) return __builtin_cpu_supports("sse2");
+#endif
+    return i==Isa::Scalar;
+}
+static inline Isa detectIsa(){ return isaSupported(Isa::AVX2) ? Isa::AVX2 : isaSupported(Isa::SSE2) ? Isa::SSE2 : Isa::Scalar; }
+
+// [RU] --- Одна матрица вместо трёх поворотов: R·scale, затем сдвиг на camZ ---
+// [EN] --- One matrix instead of three rotations: R·scale, then a camZ translation ---
+struct Xform{ float m[9]; float tz; };         // [RU] Построчно: X=m0x+m1y+m2z, Y=…, Z=…+tz
+                                               // [EN] Row-major: X=m0x+m1y+m2z, Y=…, Z=…+tz
+static inline Xform makeXform(const Pose&ps,float scale,float camZ){
+    Vec3 c0=mul(rotateAll({1,0,0},ps.sx,ps.cx,ps.sy,ps.cy,ps.sz,ps.cz),scale); // [RU] Столбцы = образы базисных векторов
+                                                                               // [EN] Columns = images of the basis vectors
+    Vec3 c1=mul(rotateAll({0,1,0},ps.sx,ps.cx,ps.sy,ps.cy,ps.sz,ps.cz),scale);
+    Vec3 c2=mul(rotateAll({0,0,1},ps.sx,ps.cx,ps.sy,ps.cy,ps.sz,ps.cz),scale);
+    return {{c0.x,c1.x,c2.x, c0.y,c1.y,c2.y, c0.z,c1.z,c2.z}, camZ};
+}
+
+// [RU] --- Константы проекции для ядра (копия Projector + ближняя плоскость) ---
+// [EN] --- Projection constants for the kernel (a copy of Projector + near plane) ---
+struct ProjK{ float fx,fy,halfW,halfH,fW,fH,nearZ; int W; };
+static inline ProjK makeProjK(const Projector&p,float nearZ){
+    return {p.fx,p.fy,p.W*0.5f,p.H*0.5f,(float)p.W,(float)p.H,std::max(nearZ,0.001f),p.W}; // [RU] 0.001 — как в toScreen
+                                                                                          // [EN] 0.001 — as in toScreen
+}
+
+// [RU] Выход ядра: idx — индекс ячейки или NO_CELL (ближняя плоскость / вне экрана), invz — 1/z.
+// [EN] Kernel output: idx — cell index or NO_CELL (near plane / off screen), invz — 1/z.
+// [RU] Отсечение по экрану делается во float (-1<X<W): trunc попадает в [0,W) ровно тогда, без UB на огромных X.
+// [EN] Screen clipping is done in float (-1<X<W): trunc lands in [0,W) exactly then, with no UB on huge X.
+static const uint32_t NO_CELL = 0xFFFFFFFFu;
+typedef void (*BatchFn)(const float*x,const float*y,const float*z,size_t n,const Xform&t,const ProjK&k,uint32_t*idx,float*invz);
+
+static void transformScalar(const float*x,const float*y,const float*z,size_t n,const Xform&t,const ProjK&k,uint32_t*idx,float*invz){
+    const float*m=t.m;
+    for(size_t i=0;i<n;++i){
+        float X=m[0]*x[i]+m[1]*y[i]+m[2]*z[i];
+        float Y=m[3]*x[i]+m[4]*y[i]+m[5]*z[i];
+        float Z=m[6]*x[i]+m[7]*y[i]+m[8]*z[i]+t.tz;
+        float iz=1.0f/Z; invz[i]=iz;
+        float sx=X*iz*k.fx+k.halfW, sy=-(Y*iz)*k.fy+k.halfH;
+        bool ok = Z>k.nearZ && sx>-1.0f && sx<k.fW && sy>-1.0f && sy<k.fH; // [RU] Ближняя плоскость + экран
+                                                                          // [EN] Near plane + screen
+        idx[i] = ok ? (uint32_t)((int)sy*k.W+(int)sx) : NO_CELL;
+    }
+}
+
+#ifdef CUBE_X86_SIMD
+__attribute__((target("sse2")))
+static void transformSSE2(const float*x,const float*y,const float*z,size_t n,const Xform&t,const ProjK&k,uint32_t*idx,float*invz){
+    const float*m=t.m; size_t i=0;
+    const __m128 m0=_mm_set1_ps(m[0]),m1=_mm_set1_ps(m[1]),m2=_mm_set1_ps(m[2]),m3=_mm_set1_ps(m[3]),m4=_mm_set1_ps(m[4]),
+                 m5=_mm_set1_ps(m[5]),m6=_mm_set1_ps(m[6]),m7=_mm_set1_ps(m[7]),m8=_mm_set1_ps(m[8]),tz=_mm_set1_ps(t.tz);
+    const __m128 fx=_mm_set1_ps(k.fx),fy=_mm_set1_ps(k.fy),hw=_mm_set1_ps(k.halfW),hh=_mm_set1_ps(k.halfH);
+    const __m128 fW=_mm_set1_ps(k.fW),fH=_mm_set1_ps(k.fH),nz=_mm_set1_ps(k.nearZ),m1f=_mm_set1_ps(-1.0f),one=_mm_set1_ps(1.0f);
+    const __m128 sign=_mm_set1_ps(-0.0f);
+    const __m128i W=_mm_set1_epi32(k.W);
+    for(;i+4<=n;i+=4){
+        __m128 px=_mm_loadu_ps(x+i),py=_mm_loadu_ps(y+i),pz=_mm_loadu_ps(z+i);
+        // [RU] Тот же порядок операций, что в скалярной версии — результат побитно совпадает
+        // [EN] Same operation order as the scalar version — results match bit for bit
+        __m128 X=_mm_add_ps(_mm_add_ps(_mm_mul_ps(m0,px),_mm_mul_ps(m1,py)),_mm_mul_ps(m2,pz));
+        __m128 Y=_mm_add_ps(_mm_add_ps(_mm_mul_ps(m3,px),_mm_mul_ps(m4,py)),_mm_mul_ps(m5,pz));
+        __m128 Z=_mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(m6,px),_mm_mul_ps(m7,py)),_mm_mul_ps(m8,pz)),tz);
+        __m128 iz=_mm_div_ps(one,Z); _mm_storeu_ps(invz+i,iz);
+        __m128 sx=_mm_add_ps(_mm_mul_ps(_mm_mul_ps(X,iz),fx),hw);
+        __m128 sy=_mm_add_ps(_mm_mul_ps(_mm_xor_ps(_mm_mul_ps(Y,iz),sign),fy),hh);
+        __m128 ok=_mm_and_ps(_mm_and_ps(_mm_cmpgt_ps(Z,nz),_mm_and_ps(_mm_cmpgt_ps(sx,m1f),_mm_cmplt_ps(sx,fW))),
+                             _mm_and_ps(_mm_cmpgt_ps(sy,m1f),_mm_cmplt_ps(sy,fH)));
+        __m128i ix=_mm_cvttps_epi32(sx), iy=_mm_cvttps_epi32(sy);
+        // [RU] SSE2 без mullo_epi32: iy*W через два 32x32→64 умножения чётных/нечётных дорожек
+        // [EN] SSE2 has no mullo_epi32: iy*W via two 32x32→64 multiplies of even/odd lanes
+        __m128i ev=_mm_mul_epu32(iy,W), od=_mm_mul_epu32(_mm_srli_epi64(iy,32),W);
+        __m128i row=_mm_unpacklo_epi32(_mm_shuffle_epi32(ev,_MM_SHUFFLE(0,0,2,0)),_mm_shuffle_epi32(od,_MM_SHUFFLE(0,0,2,0)));
+        __m128i cell=_mm_add_epi32(row,ix), okm=_mm_castps_si128(ok);
+        _mm_storeu_si128((__m128i*)(idx+i),_mm_or_si128(_mm_and_si128(okm,cell),_mm_andnot_si128(okm,_mm_set1_epi32(-1))));
+    }
+    transformScalar(x+i,y+i,z+i,n-i,t,k,idx+i,invz+i); // [RU] Хвост
+                                                       // [EN] Tail
+}
+
+__attribute__((target("avx2")))
+static void transformAVX2(const float*x,const float*y,const float*z,size_t n,const Xform&t,const ProjK&k,uint32_t*idx,float*invz){
+    const float*m=t.m; size_t i=0;
+    const __m256 m0=_mm256_set1_ps(m[0]),m1=_mm256_set1_ps(m[1]),m2=_mm256_set1_ps(m[2]),m3=_mm256_set1_ps(m[3]),m4=_mm256_set1_ps(m[4]),
+                 m5=_mm256_set1_ps(m[5]),m6=_mm256_set1_ps(m[6]),m7=_mm256_set1_ps(m[7]),m8=_mm256_set1_ps(m[8]),tz=_mm256_set1_ps(t.tz);
+    const __m256 fx=_mm256_set1_ps(k.fx),fy=_mm256_set1_ps(k.fy),hw=_mm256_set1_ps(k.halfW),hh=_mm256_set1_ps(k.halfH);
+    const __m256 fW=_mm256_set1_ps(k.fW),fH=_mm256_set1_ps(k.fH),nz=_mm256_set1_ps(k.nearZ),m1f=_mm256_set1_ps(-1.0f),one=_mm256_set1_ps(1.0f);
+    const __m256 sign=_mm256_set1_ps(-0.0f);
+    const __m256i W=_mm256_set1_epi32(k.W);
+    for(;i+8<=n;i+=8){
+        __m256 px=_mm256_loadu_ps(x+i),py=_mm256_loadu_ps(y+i),pz=_mm256_loadu_ps(z+i);
+        // [RU] Без FMA намеренно: fused-округление разошлось бы со scalar/SSE2
+        // [EN] No FMA on purpose: fused rounding would diverge from scalar/SSE2
+        __m256 X=_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m0,px),_mm256_mul_ps(m1,py)),_mm256_mul_ps(m2,pz));
+        __m256 Y=_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m3,px),_mm256_mul_ps(m4,py)),_mm256_mul_ps(m5,pz));
+        __m256 Z=_mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m6,px),_mm256_mul_ps(m7,py)),_mm256_mul_ps(m8,pz)),tz);
+        __m256 iz=_mm256_div_ps(one,Z); _mm256_storeu_ps(invz+i,iz);
+        __m256 sx=_mm256_add_ps(_mm256_mul_ps(_mm256_mul_ps(X,iz),fx),hw);
+        __m256 sy=_mm256_add_ps(_mm256_mul_ps(_mm256_xor_ps(_mm256_mul_ps(Y,iz),sign),fy),hh);
+        __m256 ok=_mm256_and_ps(_mm256_and_ps(_mm256_cmp_ps(Z,nz,_CMP_GT_OQ),_mm256_and_ps(_mm256_cmp_ps(sx,m1f,_CMP_GT_OQ),_mm256_cmp_ps(sx,fW,_CMP_LT_OQ))),
+                                _mm256_and_ps(_mm256_cmp_ps(sy,m1f,_CMP_GT_OQ),_mm256_cmp_ps(sy,fH,_CMP_LT_OQ)));
+        __m256i cell=_mm256_add_epi32(_mm256_mullo_epi32(_mm256_cvttps_epi32(sy),W),_mm256_cvttps_epi32(sx));
+        _mm256_storeu_si256((__m256i*)(idx+i),_mm256_or_si256(cell,_mm256_xor_si256(_mm256_castps_si256(ok),_mm256_set1_epi32(-1))));
+    }
+    transformScalar(x+i,y+i,z+i,n-i,t,k,idx+i,invz+i); // [RU] Хвост
+                                                       // [EN] Tail
+}
+#endif
+
+static inline BatchFn batchKernel(Isa i){      // [RU] Диспетчеризация; неподдерживаемое → scalar
+                                               // [EN] Dispatch; anything unsupported → scalar
+#ifdef CUBE_X86_SIMD
+    if(i==Isa::AVX2&&isaSupported(Isa::AVX2)) return transformAVX2;
+    if(i==Isa::SSE2&&isaSupported(Isa::SSE2)) return transformSSE2;
+#endif
+    (void)i; return transformScalar;
+}
+
+// [RU] --- Сэмплер на пакетном ядре: сетка граней в SoA, одна матрица на кадр ---
+// [EN] --- Sampler on the batch kernel: face grids in SoA, one matrix per frame ---
+struct BatchSampler{
+    Isa isa = detectIsa();                     // [RU] Можно переопределить (--isa) для сравнения
+                                               // [EN] May be overridden (--isa) for comparison
+    float gridStep = 0.0f;                     // [RU] Шаг, под который построены сетки
+                                               // [EN] Step the grids were built for
+    std::vector<float> fx[6],fy[6],fz[6];      // [RU] Точки граней в пространстве объекта (без масштаба)
+                                               // [EN] Face points in object space (unscaled)
+    std::vector<uint32_t> idx; std::vector<float> invz; // [RU] Выход ядра — переиспользуется
+                                                        // [EN] Kernel output — reused
+
+    void buildGrids(float step){               // [RU] Та же (u,v)-последовательность, что у сэмплера
+                                               // [EN] Same (u,v) sequence as the sampler
+        gridStep=step;
+        for(int fi=0;fi<6;++fi){ fx[fi].clear(); fy[fi].clear(); fz[fi].clear();
+            for(float u=-1.0f; u < 1.0f + step/2; u+=step)
+                for(float v=-1.0f; v < 1.0f + step/2; v+=step){
+                    Vec3 p=pointOnFace(cubeFaces[fi],u,v); fx[fi].push_back(p.x); fy[fi].push_back(p.y); fz[fi].push_back(p.z); }
+        }
+        idx.resize(fx[0].size()); invz.resize(fx[0].size());
+    }
+
+    void render(Frame&fr,const Projector&proj,const RenderParams&rp,const Pose&ps){
+        fr.clear();
+        if(gridStep!=rp.step) buildGrids(rp.step); // [RU] Перестройка только при смене шага
+                                                   // [EN] Rebuild only when the step changes
+        const BatchFn kern=batchKernel(isa);
+        const Xform t=makeXform(ps,rp.cubeScale,rp.camZ);
+        const ProjK k=makeProjK(proj,rp.nearZ);
+        for(int faceIndex=0; faceIndex<6; ++faceIndex){
+            float shadeF; if(!litFace(faceIndex,ps,rp,shadeF)) continue; // [RU] Отсечение задних граней + свет
+                                                                         // [EN] Back-face culling + lighting
+            const Cell c{shadeGlyph(rp,shadeF),faceColors[faceIndex]};   // [RU] Символ один на грань — считаем один раз
+                                                                         // [EN] One glyph per face — computed once
+            TRACE_SCOPE(TS_FACE,faceIndex);
+            const float bias=1e-5f*(float)faceIndex;
+            const size_t n=fx[faceIndex].size();
+            kern(fx[faceIndex].data(),fy[faceIndex].data(),fz[faceIndex].data(),n,t,k,idx.data(),invz.data());
+            TRACE_COUNT(TC_SAMPLES,n);
+#ifdef CUBE_TRACE
+            for(size_t i=0;i<n;++i) if(idx[i]==NO_CELL){ // [RU] Ядро отдаёт один признак — причину восстанавливаем по Z
+                                                         // [EN] The kernel returns one marker — the reason is recovered from Z
+                const float Z=t.m[6]*fx[faceIndex][i]+t.m[7]*fy[faceIndex][i]+t.m[8]*fz[faceIndex][i]+t.tz;
+                TRACE_COUNT(Z>k.nearZ ? TC_SCREEN : TC_NEAR,1); }
+#endif
+            for(size_t i=0;i<n;++i){ uint32_t j=idx[i]; if(j==NO_CELL) continue; // [RU] Z-тест — пишем только ближнее
+                                                                                 // [EN] Z-test — write only the nearer
+                fr.plot(j,invz[i]+bias,c); }
+        }
+    }
+};
@@ -0,0 +1,132 @@
+// [RU] === tiles.h — многопоточный тайловый рендер: пул потоков с кражей работы + тайлы со своими z/символами ===
+// [EN] === tiles.h — multithreaded tiled rendering: work-stealing thread pool + tiles owning their z/char cells ===
+#pragma once
+#include "raster.h"                            // [RU] Prim, cubePrims, fillPrim
+                                               // [EN] Prim, cubePrims, fillPrim
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// [RU] --- Постоянный пул потоков: задания — индексы 0..n-1, у каждого потока свой диапазон, свободный поток крадёт чужие ---
+// [EN] --- Persistent thread pool: jobs are indices 0..n-1, each thread owns a range, an idle thread steals from others ---
+struct WorkerPool{
+    typedef void (*JobFn)(void*ctx,int job);   // [RU] Без std::function — ноль аллокаций на кадр
+                                               // [EN] No std::function — zero allocations per frame
+    struct alignas(64) Range{ std::atomic<int> next{0}; int end=0; }; // [RU] Своя строка кеша на курсор
+                                                                      // [EN] One cache line per cursor
+    int n;                                     // [RU] Всего исполнителей, включая вызывающий поток
+                                               // [EN] Total workers, including the calling thread
+    std::unique_ptr<Range[]> ranges;
+    std::vector<std::thread> threads;
+    std::mutex m; std::condition_variable cvStart, cvDone;
+    uint64_t epoch=0; int pending=0; bool quit=false;
+    JobFn fn=nullptr; void*ctx=nullptr;
+
+    explicit WorkerPool(int threadsTotal):n(std::max(1,threadsTotal)),ranges(new Range[(size_t)n]){
+        for(int w=1;w<n;++w) threads.emplace_back([this,w]{ loop(w); }); // [RU] Поток 0 — вызывающий
+                                                                         // [EN] Worker 0 is the caller
+    }
+    ~WorkerPool(){ { std::lock_guard<std::mutex> l(m); quit=true; } cvStart.notify_all(); for(auto&t:threads) t.join(); }
+
+    void run(int jobs,JobFn f,void*c){         // [RU] Блокирует, пока все задания не выполнены
+                                               // [EN] Blocks until every job has run
+        if(n==1||jobs<=1){ for(int j=0;j<jobs;++j) f(c,j); return; }
+        for(int w=0;w<n;++w){ ranges[w].next.store(jobs*w/n,std::memory_order_relaxed); ranges[w].end=jobs*(w+1)/n; } // [RU] Непрерывные куски
+                                                                                                                        // [EN] Contiguous chunks
+        { std::lock_guard<std::mutex> l(m); fn=f; ctx=c; pending=n-1; ++epoch; }
+        cvStart.notify_all();
+        work(0);
+        std::unique_lock<std::mutex> l(m); cvDone.wait(l,[this]{ return pending==0; });
+    }
+
+private:
+    void work(int self){                       // [RU] Сначала свой диапазон, затем по кругу чужие
+                                               // [EN] Own range first, then the others round-robin
+        for(int k=0;k<n;++k){ Range&r=ranges[(self+k)%n];
+            for(;;){ int j=r.next.fetch_add(1,std::memory_order_relaxed); if(j>=r.end) break; fn(ctx,j); } }
+    }
+    void loop(int self){
+        TRACE_THREAD();                        // [RU] Регистрация в trace — при старте, не в кадре
+                                               // [EN] Trace registration — at startup, not in a frame
+        uint64_t seen=0;
+        for(;;){
+            { std::unique_lock<std::mutex> l(m); cvStart.wait(l,[&]{ return quit||epoch!=seen; }); if(quit) return; seen=epoch; }
+            work(self);
+            { std::lock_guard<std::mutex> l(m); if(--pending==0) cvDone.notify_one(); }
+        }
+    }
+};
+
+// [RU] --- Тайловый растеризатор: экран режется на тайлы, примитивы раскладываются по корзинам тайлов ---
+// [EN] --- Tiled rasterizer: the screen is cut into tiles, primitives are binned into per-tile lists ---
+// [RU] Тайл пишет только свой прямоугольник ячеек — атомики на горячем пути не нужны,
+// [RU] а порядок примитивов в корзине совпадает с однопоточным, поэтому кадр побитно тот же.
+// [EN] A tile writes only its own rectangle of cells — no atomics on the hot path,
+// [EN] and primitives keep their single-threaded order within a bin, so the frame is bit-identical.
+struct TiledRaster{
+    int threads=1;                             // [RU] Потоков всего (1 — тайлы без пула)
+                                               // [EN] Total threads (1 — tiles without the pool)
+    int tileW=64, tileH=16;                    // [RU] Размер тайла в ячейках
+                                               // [EN] Tile size in cells
+    std::unique_ptr<WorkerPool> pool;
+    std::vector<Prim> prims;                   // [RU] Примитивы кадра — переиспользуются
+                                               // [EN] Frame primitives — reused
+    std::vector<int> binStart, binFill;        // [RU] Корзина тайла t — binItems[binStart[t]..binStart[t+1]); binFill — курсор записи
+                                               // [EN] Tile t's bin is binItems[binStart[t]..binStart[t+1]); binFill is the write cursor
+    std::vector<int> binItems;                 // [RU] Индексы примитивов всех корзин подряд, в исходном порядке
+                                               // [EN] Primitive indices of all bins back to back, in original order
+    int tilesX=0, tilesY=0;
+    Frame*fr=nullptr;                          // [RU] Контекст текущего кадра для заданий пула
+                                               // [EN] Current frame context for pool jobs
+
+    void setThreads(int t){ t=std::max(1,t); if(t!=threads||!pool){ threads=t; pool.reset(new WorkerPool(t)); } }
+
+    void bin(int W,int H){                     // [RU] Раскладка по тайлам по габаритам примитива: подсчёт, префиксная сумма, запись
+                                               // [EN] Binning by primitive bounds: count, prefix sum, write
+        TRACE_SCOPE(TS_BIN,-1);
+        tilesX=(W+tileW-1)/tileW; tilesY=(H+tileH-1)/tileH;
+        const size_t nt=(size_t)tilesX*tilesY;
+        if(binStart.size()!=nt+1){ binStart.assign(nt+1,0); binFill.assign(nt,0); binItems.reserve(nt*6); } // [RU] Только при смене сетки тайлов;
+                                                                                                              // [RU] 6 граней куба на каждый тайл — больше кубу не нужно
+                                                                                                              // [EN] Only when the tile grid changes;
+                                                                                                              // [EN] 6 cube faces per tile — the cube never needs more
+        std::fill(binStart.begin(),binStart.end(),0);
+        for(const Prim&p:prims)
+            for(int ty=p.y0/tileH; ty<=(p.y1-1)/tileH; ++ty)
+                for(int tx=p.x0/tileW; tx<=(p.x1-1)/tileW; ++tx) ++binStart[(size_t)ty*tilesX+tx+1];
+        for(size_t t=0;t<nt;++t){ binStart[t+1]+=binStart[t]; binFill[t]=binStart[t]; }
+        binItems.resize((size_t)binStart[nt]);  // [RU] Растёт только на новом максимуме (сцены мешей)
+                                               // [EN] Grows only on a new maximum (mesh scenes)
+        for(int i=0;i<(int)prims.size();++i){ const Prim&p=prims[(size_t)i];
+            for(int ty=p.y0/tileH; ty<=(p.y1-1)/tileH; ++ty)
+                for(int tx=p.x0/tileW; tx<=(p.x1-1)/tileW; ++tx) binItems[(size_t)binFill[(size_t)ty*tilesX+tx]++]=i; }
+    }
+
+    static void tileJob(void*self,int t){      // [RU] Заливка примитивов своего прямоугольника (очистку заменило поколение кадра)
+                                               // [EN] Fill the primitives of own rectangle (the frame generation replaced clearing)
+        TRACE_SCOPE(TS_TILE,t);
+        TiledRaster&tr=*(TiledRaster*)self; Frame&fr=*tr.fr;
+        const int x0=(t%tr.tilesX)*tr.tileW, y0=(t/tr.tilesX)*tr.tileH;
+        const int x1=std::min(fr.W,x0+tr.tileW), y1=std::min(fr.H,y0+tr.tileH);
+        for(int k=tr.binStart[(size_t)t];k<tr.binStart[(size_t)t+1];++k){ const int i=tr.binItems[(size_t)k];
+            TRACE_SCOPE(TS_FACE,i); fillPrim(fr,tr.prims[(size_t)i],x0,y0,x1,y1); } // [RU] Кусок примитива внутри тайла
+                                                                                   // [EN] The primitive's piece within the tile
+    }
+
+    void render(Frame&f,const Projector&proj,const RenderParams&rp,const Pose&ps){
+        prims.resize(6); prims.resize((size_t)cubePrims(prims.data(),proj,rp,ps)); // [RU] Подготовка — последовательно, она дешёвая
+                                                                                   // [EN] Setup is serial — it is cheap
+        renderPrims(f);
+    }
+    void renderPrims(Frame&f){                 // [RU] Новое поколение + заливка уже готовых prims (куб или сцена мешей)
+                                               // [EN] Bump generation + fill the prims already in place (the cube or a mesh scene)
+        if(!pool) setThreads(threads);
+        f.clear();                             // [RU] Новое поколение — до запуска пула, один раз на кадр
+                                               // [EN] New generation — before the pool starts, once per frame
+        bin(f.W,f.H);
+        fr=&f; pool->run(tilesX*tilesY,tileJob,this); fr=nullptr;
+    }
+};
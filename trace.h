@@ -0,0 +1,194 @@
+// [RU] === trace.h — инструментирование горячего пути: счётчики, времена стадий, экспорт в Chrome trace_event ===
+// [EN] === trace.h — hot-path instrumentation: counters, stage timings, Chrome trace_event export ===
+#pragma once
+#include <cstdint>
+#include <cstdio>                              // [RU] Итоговая таблица и JSON
+                                               // [EN] Summary table and JSON
+
+// [RU] Собирается только с -DCUBE_TRACE; без него макросы пусты, а функции — заглушки, и горячий путь не меняется.
+// [EN] Built only with -DCUBE_TRACE; without it the macros are empty and the functions are stubs, so the hot path is unchanged.
+enum TraceCounter{
+    TC_SAMPLES,                                // [RU] Точки сэмплера / ячейки, проверенные заливкой
+                                               // [EN] Sampler points / cells tested by the fill
+    TC_NEAR,                                   // [RU] Отброшено ближней плоскостью (p.z<=nearZ)
+                                               // [EN] Rejected by the near plane (p.z<=nearZ)
+    TC_SCREEN,                                 // [RU] Отброшено границами экрана
+                                               // [EN] Rejected by the screen bounds
+    TC_ZREJECT,                                // [RU] Проиграли z-тест
+                                               // [EN] Lost the z-test
+    TC_WRITTEN,                                // [RU] Первая запись в ячейку за кадр
+                                               // [EN] First write to a cell this frame
+    TC_OVERDRAW,                               // [RU] Перезапись уже закрашенной ячейки более близкой точкой
+                                               // [EN] Overwrite of an already painted cell by a nearer point
+    TC_COUNT
+};
+enum TraceStage{
+    TS_INPUT,                                  // [RU] Разбор очереди клавиш
+                                               // [EN] Draining the key queue
+    TS_GEOM,                                   // [RU] Запрос размера консоли/терминала
+                                               // [EN] Console/terminal size query
+    TS_CLEAR,                                  // [RU] Очистка кадра (смена поколения, изредка — стирание)
+                                               // [EN] Frame clear (generation bump, rarely a wipe)
+    TS_SETUP,                                  // [RU] Подготовка примитивов куба или сцены
+                                               // [EN] Cube or scene primitive setup
+    TS_BIN,                                    // [RU] Раскладка примитивов по тайлам
+                                               // [EN] Binning primitives into tiles
+    TS_FACE,                                   // [RU] Растр одной грани/примитива; arg — её индекс
+                                               // [EN] Raster of one face/primitive; arg is its index
+    TS_TILE,                                   // [RU] Задание тайла в пуле; arg — номер тайла
+                                               // [EN] A tile job on the pool; arg is the tile number
+    TS_BLIT,                                   // [RU] Вывод кадра в цель
+                                               // [EN] Presenting the frame to the target
+    TS_COUNT
+};
+static const char*const traceCounterNames[TC_COUNT]={"samples","near-clipped","screen-clipped","z-rejected","written","overdraw"};
+static const char*const traceStageNames[TS_COUNT]={"input","geometry","clear","setup","bin","face","tile","blit"};
+
+#ifdef CUBE_TRACE
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// [RU] Каждый поток пишет только в свой блок — без атомиков; чужие блоки читаются, когда пул стоит (конец кадра, выход).
+// [RU] Буферы событий резервируются при регистрации потока и дальше не растут: лишние события считаются в lost.
+// [EN] Each thread writes only to its own block — no atomics; other blocks are read while the pool is idle (frame end, exit).
+// [EN] Event buffers are reserved when a thread registers and never grow: excess events are counted in lost.
+struct TraceEvent{ uint64_t ts,dur; int32_t arg; uint8_t stage; };
+struct TraceFrame{ uint64_t ts; uint64_t count[TC_COUNT]; }; // [RU] Счётчики одного кадра — для графика в trace viewer
+                                                             // [EN] One frame's counters — for the chart in the trace viewer
+struct TraceThread{
+    enum{ CAP=1<<16, FRAME_CAP=1<<16 };
+    int tid=0;
+    uint64_t count[TC_COUNT]={};
+    uint64_t stageN[TS_COUNT]={}, stageNs[TS_COUNT]={}, stageMax[TS_COUNT]={};
+    std::vector<TraceEvent> ev; uint64_t lost=0;
+    std::vector<TraceFrame> frames; uint64_t framesLost=0; // [RU] Ряд кадров — только у потока, вызывающего traceFrame
+                                                           // [EN] Frame series — only in the thread that calls traceFrame
+    uint64_t last[TC_COUNT]={}, frameMax[TC_COUNT]={};
+};
+struct Trace{
+    enum{ MAX_THREADS=256 };
+    const std::chrono::steady_clock::time_point t0=std::chrono::steady_clock::now();
+    std::mutex mu;                             // [RU] Только регистрация потоков и выгрузка на выходе — не кадр
+                                               // [EN] Thread registration and the exit dump only — never the frame
+    std::unique_ptr<TraceThread> threads[MAX_THREADS];
+    std::atomic<int> nThreads{0};              // [RU] Опубликованные блоки threads[0..n) читаются без блокировки
+                                               // [EN] Published blocks threads[0..n) are read without the lock
+
+    static Trace&get(){ static Trace t; return t; }
+    uint64_t now()const{ return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now()-t0).count(); }
+    TraceThread&local(){                       // [RU] Один раз на поток; TRACE_THREAD() выносит это из кадра
+                                               // [EN] Once per thread; TRACE_THREAD() moves it out of the frame
+        thread_local TraceThread*self=nullptr;
+        if(!self){ std::lock_guard<std::mutex> lk(mu);
+            const int n=nThreads.load(std::memory_order_relaxed);
+            if(n==MAX_THREADS){ thread_local TraceThread spare; self=&spare; return *self; } // [RU] Сверх лимита — не попадает в отчёт
+                                                                                          // [EN] Past the limit — left out of the report
+            threads[n].reset(new TraceThread); self=threads[n].get();
+            self->tid=n+1; self->ev.reserve(TraceThread::CAP);
+            nThreads.store(n+1,std::memory_order_release); }
+        return *self;
+    }
+    void totals(uint64_t*out)const{
+        for(int c=0;c<TC_COUNT;++c) out[c]=0;
+        const int n=nThreads.load(std::memory_order_acquire);
+        for(int i=0;i<n;++i) for(int c=0;c<TC_COUNT;++c) out[c]+=threads[i]->count[c];
+    }
+};
+
+struct TraceScope{                             // [RU] Полное событие ("ph":"X") от конструктора до деструктора
+                                               // [EN] A complete event ("ph":"X") from constructor to destructor
+    TraceThread&th; uint64_t t; int32_t arg; uint8_t stage;
+    TraceScope(TraceStage s,int a):th(Trace::get().local()),t(Trace::get().now()),arg(a),stage((uint8_t)s){}
+    ~TraceScope(){
+        const uint64_t d=Trace::get().now()-t;
+        ++th.stageN[stage]; th.stageNs[stage]+=d; if(d>th.stageMax[stage]) th.stageMax[stage]=d;
+        if(th.ev.size()<th.ev.capacity()) th.ev.push_back({t,d,arg,stage}); else ++th.lost;
+    }
+};
+
+#define TRACE_CAT2(a,b) a##b
+#define TRACE_CAT(a,b) TRACE_CAT2(a,b)
+#define TRACE_SCOPE(stage,arg) TraceScope TRACE_CAT(traceScope_,__LINE__)(stage,arg)
+#define TRACE_COUNT(counter,n) (Trace::get().local().count[counter]+=(uint64_t)(n))
+#define TRACE_THREAD() ((void)Trace::get().local())
+#define TRACE_FRAME() traceFrame()
+
+static inline bool traceEnabled(){ return true; }
+static inline void traceTotals(uint64_t*out){ Trace::get().totals(out); }
+
+// [RU] Кадровый поток готовит ряд кадров заранее, до цикла
+// [EN] The frame thread reserves its frame series up front, before the loop
+static inline void traceFrameReserve(){ TraceThread&th=Trace::get().local(); if(th.frames.capacity()<TraceThread::FRAME_CAP) th.frames.reserve(TraceThread::FRAME_CAP); }
+
+// [RU] Конец кадра (пул стоит): приращения счётчиков за кадр и их максимумы — в блок вызывающего потока, без блокировок
+// [EN] End of a frame (the pool is idle): per-frame counter deltas and their maxima — into the caller's block, lock-free
+static inline void traceFrame(){
+    Trace&tr=Trace::get(); TraceThread&th=tr.local(); uint64_t cur[TC_COUNT]; tr.totals(cur);
+    TraceFrame f; f.ts=tr.now();
+    for(int c=0;c<TC_COUNT;++c){ f.count[c]=cur[c]-th.last[c]; th.last[c]=cur[c]; if(f.count[c]>th.frameMax[c]) th.frameMax[c]=f.count[c]; }
+    if(th.frames.size()<th.frames.capacity()) th.frames.push_back(f); else ++th.framesLost;
+}
+
+// [RU] JSON для chrome://tracing и Perfetto: события стадий по потокам + счётчик "cells" на каждый кадр
+// [EN] JSON for chrome://tracing and Perfetto: stage events per thread + a "cells" counter per frame
+static inline bool traceWrite(const char*path){
+    Trace&tr=Trace::get(); std::lock_guard<std::mutex> lk(tr.mu);
+    FILE*f=std::fopen(path,"wb"); if(!f) return false;
+    std::fprintf(f,"{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+    bool first=true;
+    auto sep=[&]{ std::fputs(first?"":",\n",f); first=false; };
+    const int nt=tr.nThreads.load(std::memory_order_acquire);
+    for(int i=0;i<nt;++i){ const TraceThread*t=tr.threads[i].get();
+        sep(); std::fprintf(f,"{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s %d\"}}",t->tid,t->tid==1?"main":"thread",t->tid);
+        for(const TraceEvent&e:t->ev){
+            sep(); std::fprintf(f,"{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f",traceStageNames[e.stage],t->tid,(double)e.ts/1e3,(double)e.dur/1e3);
+            if(e.arg>=0) std::fprintf(f,",\"args\":{\"i\":%d}",(int)e.arg);
+            std::fputc('}',f);
+        }
+    }
+    for(int i=0;i<nt;++i) for(const TraceFrame&fr:tr.threads[i]->frames){
+        sep(); std::fprintf(f,"{\"name\":\"cells\",\"ph\":\"C\",\"pid\":1,\"ts\":%.3f,\"args\":{",(double)fr.ts/1e3);
+        for(int c=0;c<TC_COUNT;++c) std::fprintf(f,"%s\"%s\":%llu",c?",":"",traceCounterNames[c],(unsigned long long)fr.count[c]);
+        std::fputs("}}",f);
+    }
+    std::fprintf(f,"\n]}\n");
+    return std::fclose(f)==0;
+}
+
+// [RU] Итоговая таблица: стадии (по всем потокам) и счётчики на кадр; overdraw/cell — перезаписи на закрашенную ячейку
+// [EN] Summary table: stages (across all threads) and counters per frame; overdraw/cell — overwrites per painted cell
+static inline void tracePrint(FILE*o){
+    Trace&tr=Trace::get(); uint64_t tot[TC_COUNT]; tr.totals(tot);
+    std::lock_guard<std::mutex> lk(tr.mu);
+    uint64_t n[TS_COUNT]={}, ns[TS_COUNT]={}, mx[TS_COUNT]={}, fmax[TC_COUNT]={}, lost=0, events=0, frames=0;
+    const int nt=tr.nThreads.load(std::memory_order_acquire);
+    for(int i=0;i<nt;++i){ const TraceThread*t=tr.threads[i].get(); lost+=t->lost; events+=t->ev.size(); frames+=t->frames.size()+t->framesLost; // [RU] Слияние блоков — только здесь
+                                                                                                                                       // [EN] Blocks are merged only here
+        for(int s=0;s<TS_COUNT;++s){ n[s]+=t->stageN[s]; ns[s]+=t->stageNs[s]; mx[s]=std::max(mx[s],t->stageMax[s]); }
+        for(int c=0;c<TC_COUNT;++c) fmax[c]=std::max(fmax[c],t->frameMax[c]); }
+    std::fprintf(o,"trace: %llu frames, %d threads, %llu events (%llu lost)\n",(unsigned long long)frames,nt,(unsigned long long)events,(unsigned long long)lost);
+    std::fprintf(o,"%-15s %10s %12s %10s %10s %10s\n","stage","count","total ms","mean us","max us","us/frame");
+    for(int s=0;s<TS_COUNT;++s) if(n[s])
+        std::fprintf(o,"%-15s %10llu %12.2f %10.2f %10.2f %10.2f\n",traceStageNames[s],(unsigned long long)n[s],(double)ns[s]/1e6,(double)ns[s]/(double)n[s]/1e3,
+                     (double)mx[s]/1e3,frames?(double)ns[s]/(double)frames/1e3:0.0);
+    std::fprintf(o,"%-15s %14s %12s %12s\n","counter","total","per frame","max/frame");
+    for(int c=0;c<TC_COUNT;++c)
+        std::fprintf(o,"%-15s %14llu %12.1f %12llu\n",traceCounterNames[c],(unsigned long long)tot[c],frames?(double)tot[c]/(double)frames:0.0,(unsigned long long)fmax[c]);
+    std::fprintf(o,"overdraw/cell   %14.3f\n",tot[TC_WRITTEN]?(double)tot[TC_OVERDRAW]/(double)tot[TC_WRITTEN]:0.0);
+}
+#else
+#define TRACE_SCOPE(stage,arg) ((void)0)
+#define TRACE_COUNT(counter,n) ((void)0)
+#define TRACE_THREAD() ((void)0)
+#define TRACE_FRAME() ((void)0)
+
+static inline bool traceEnabled(){ return false; }
+static inline void traceTotals(uint64_t*out){ for(int c=0;c<TC_COUNT;++c) out[c]=0; }
+static inline void traceFrameReserve(){}
+static inline bool traceWrite(const char*){ return false; }
+static inline void tracePrint(FILE*){}
+#endif